@@ -0,0 +1,163 @@
+//
+// Created by User on 2026-04-18.
+//
+
+#include "allocator.hpp"
+#include <algorithm>
+#include <bit>
+#include <iterator>
+
+size_t SlotAllocator::class_of(size_t n) {
+    return static_cast<size_t>(std::bit_width(n - 1));
+}
+
+std::optional<size_t> SlotAllocator::allocate(size_t n) {
+    std::optional<size_t> base;
+    size_t size;
+    if (n <= MAX_SMALL) {
+        size_t c = class_of(n);
+        size = class_size(c);
+        if (small_free[c].empty()) {
+            // carve a whole chunk into blocks of this class
+            auto chunk = take_run(CHUNK);
+            if (!chunk) {
+                return std::nullopt;
+            }
+            for (size_t at = *chunk + CHUNK; at > *chunk; at -= size) {
+                small_free[c].push_back(at - size);
+            }
+        }
+        base = small_free[c].back();
+        small_free[c].pop_back();
+    } else {
+        size = (n + LARGE_ALIGN - 1) / LARGE_ALIGN * LARGE_ALIGN;
+        base = take_run(size);
+        if (!base) {
+            return std::nullopt;
+        }
+    }
+    live.emplace(*base, size);
+    live_slots += size;
+    allocations++;
+    return base;
+}
+
+size_t SlotAllocator::region_size(size_t n) const {
+    if (n <= MAX_SMALL) {
+        return CHUNK;
+    }
+    return std::max(CHUNK, (n + LARGE_ALIGN - 1) / LARGE_ALIGN * LARGE_ALIGN);
+}
+
+void SlotAllocator::add_region(size_t base, size_t n) {
+    add_run(base, n);
+    managed_end = std::max(managed_end, base + n);
+}
+
+std::optional<size_t> SlotAllocator::release(size_t base) {
+    auto it = live.find(base);
+    if (it == live.end()) {
+        return std::nullopt;
+    }
+    size_t size = it->second;
+    live.erase(it);
+    live_slots -= size;
+    releases++;
+    if (size <= MAX_SMALL) {
+        small_free[class_of(size)].push_back(base);
+    } else {
+        add_run(base, size);
+    }
+    return size;
+}
+
+void SlotAllocator::truncate(size_t end) {
+    if (end >= managed_end) {
+        return;
+    }
+    // a block that straddles end is dropped whole; the part below end is not reused
+    for (size_t c = 0; c < CLASS_COUNT; c++) {
+        std::erase_if(small_free[c], [&](size_t b) { return b + class_size(c) > end; });
+    }
+    for (auto it = live.begin(); it != live.end();) {
+        if (it->first + it->second > end) {
+            live_slots -= it->second;
+            it = live.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    auto it = runs_by_base.lower_bound(end);
+    if (it != runs_by_base.begin()) {
+        auto prev = std::prev(it);
+        if (prev->first + prev->second > end) {
+            size_t base = prev->first;
+            erase_run(prev);
+            add_run(base, end - base);
+        }
+    }
+    while (true) {
+        it = runs_by_base.lower_bound(end);
+        if (it == runs_by_base.end()) {
+            break;
+        }
+        erase_run(it);
+    }
+    managed_end = end;
+}
+
+SlotAllocator::Stats SlotAllocator::stats() const {
+    size_t free_slots = 0;
+    for (size_t c = 0; c < CLASS_COUNT; c++) {
+        free_slots += small_free[c].size() * class_size(c);
+    }
+    for (const auto& [base, length] : runs_by_base) {
+        free_slots += length;
+    }
+    return Stats{
+        .live_blocks = live.size(),
+        .live_slots = live_slots,
+        .free_slots = free_slots,
+        .allocations = allocations,
+        .releases = releases,
+    };
+}
+
+// best fit: the shortest free run that holds n, with the rest split off
+std::optional<size_t> SlotAllocator::take_run(size_t n) {
+    auto fit = runs_by_size.lower_bound({n, 0});
+    if (fit == runs_by_size.end()) {
+        return std::nullopt;
+    }
+    auto [length, base] = *fit;
+    erase_run(runs_by_base.find(base));
+    if (length > n) {
+        add_run(base + n, length - n);
+    }
+    return base;
+}
+
+// inserts a free run, merged with the runs directly before and after it
+void SlotAllocator::add_run(size_t base, size_t n) {
+    auto next = runs_by_base.lower_bound(base);
+    if (next != runs_by_base.end() && base + n == next->first) {
+        n += next->second;
+        erase_run(next);
+    }
+    auto after = runs_by_base.lower_bound(base);
+    if (after != runs_by_base.begin()) {
+        auto prev = std::prev(after);
+        if (prev->first + prev->second == base) {
+            base = prev->first;
+            n += prev->second;
+            erase_run(prev);
+        }
+    }
+    runs_by_base.emplace(base, n);
+    runs_by_size.emplace(n, base);
+}
+
+void SlotAllocator::erase_run(std::map<size_t, size_t>::iterator it) {
+    runs_by_size.erase({it->second, it->first});
+    runs_by_base.erase(it);
+}
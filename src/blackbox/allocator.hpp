@@ -0,0 +1,74 @@
+//
+// Created by User on 2026-04-18.
+//
+
+#ifndef BLACKBOX_ALLOCATOR_HPP
+#define BLACKBOX_ALLOCATOR_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// bookkeeping behind HALLOC/HFREE. it hands out runs of heap slots from regions the VM grew for
+// it and never touches the slots themselves; block sizes live here rather than in headers inside
+// the heap, so a program cannot corrupt them.
+//
+// requests up to MAX_SMALL slots are rounded to a power of two and served from a free list per
+// size class, refilled a CHUNK at a time. bigger ones are rounded to a multiple of LARGE_ALIGN
+// and taken best-fit from free runs that are split on allocation and merged with their
+// neighbours on release, so freeing and reallocating large blocks does not fragment the heap
+class SlotAllocator {
+  public:
+    static constexpr size_t MAX_SMALL = 256;
+    static constexpr size_t CHUNK = 4096;
+    static constexpr size_t LARGE_ALIGN = 8;
+
+    struct Stats {
+        size_t live_blocks = 0;
+        size_t live_slots = 0;
+        size_t free_slots = 0;
+        uint64_t allocations = 0;
+        uint64_t releases = 0;
+    };
+
+    // first slot of a block of at least n slots (n > 0), or nullopt when the free lists cannot
+    // serve it; the caller then grows the heap by region_size(n) and calls add_region
+    std::optional<size_t> allocate(size_t n);
+    size_t region_size(size_t n) const;
+    void add_region(size_t base, size_t n);
+
+    // returns the block's size, or nullopt when base does not start a live block
+    std::optional<size_t> release(size_t base);
+
+    // forgets every block and free run at or past end, after the heap shrank under them
+    void truncate(size_t end);
+    size_t end() const { return managed_end; }
+
+    Stats stats() const;
+
+  private:
+    static constexpr size_t CLASS_COUNT = 9; // 1, 2, 4, ... MAX_SMALL
+
+    std::array<std::vector<size_t>, CLASS_COUNT> small_free;
+    std::map<size_t, size_t> runs_by_base;           // free large runs: base -> length
+    std::set<std::pair<size_t, size_t>> runs_by_size; // (length, base)
+    std::unordered_map<size_t, size_t> live;         // block base -> block size
+    size_t managed_end = 0;
+    size_t live_slots = 0;
+    uint64_t allocations = 0;
+    uint64_t releases = 0;
+
+    static size_t class_of(size_t n);
+    static size_t class_size(size_t c) { return size_t{1} << c; }
+    std::optional<size_t> take_run(size_t n);
+    void add_run(size_t base, size_t n);
+    void erase_run(std::map<size_t, size_t>::iterator it);
+};
+
+#endif // BLACKBOX_ALLOCATOR_HPP
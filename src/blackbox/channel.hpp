@@ -0,0 +1,122 @@
+//
+// Created by User on 2026-04-18.
+//
+
+#ifndef BLACKBOX_CHANNEL_HPP
+#define BLACKBOX_CHANNEL_HPP
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// bounded single-producer/single-consumer ring connecting two VMs.
+// string messages carry their bytes because handles are local to each VM's string table
+class Channel {
+  public:
+    struct Message {
+        int64_t value = 0;
+        std::string text;
+        bool is_string = false;
+    };
+
+    explicit Channel(size_t capacity = 1024)
+        : slots(std::bit_ceil(capacity < 2 ? size_t{2} : capacity)), mask(slots.size() - 1) {}
+
+    Channel(const Channel&) = delete;
+    Channel& operator=(const Channel&) = delete;
+
+    // false when full, or when the receiver is gone (the message is dropped)
+    bool try_send(Message& msg) {
+        uint64_t seen;
+        return try_send(msg, seen);
+    }
+
+    bool try_recv(Message& out) {
+        uint64_t seen;
+        return try_recv(out, seen);
+    }
+
+    // send and recv sleep on exactly the position the failed attempt saw, so a publish that lands
+    // between the attempt and the wait changes the atomic and the wait returns at once
+    void send(Message msg) {
+        uint64_t h;
+        while (!try_send(msg, h)) {
+            head.wait(h, std::memory_order_acquire);
+        }
+    }
+
+    // blocks until a message arrives; false once the sender closed and the ring is drained
+    bool recv(Message& out) {
+        uint64_t t;
+        while (!try_recv(out, t)) {
+            if (t & CLOSED) {
+                return false;
+            }
+            tail.wait(t, std::memory_order_acquire);
+        }
+        return true;
+    }
+
+    bool full() const {
+        uint64_t h = head.load(std::memory_order_acquire);
+        uint64_t t = tail.load(std::memory_order_relaxed) & ~CLOSED;
+        return !(h & CLOSED) && t - h == slots.size();
+    }
+
+    // true once the sender closed and every message was consumed
+    bool drained() const {
+        uint64_t t = tail.load(std::memory_order_acquire);
+        uint64_t h = head.load(std::memory_order_relaxed) & ~CLOSED;
+        return (t & CLOSED) && (t & ~CLOSED) == h;
+    }
+
+    void close_send() {
+        tail.fetch_or(CLOSED, std::memory_order_acq_rel);
+        tail.notify_all();
+    }
+
+    void close_recv() {
+        head.fetch_or(CLOSED, std::memory_order_acq_rel);
+        head.notify_all();
+    }
+
+  private:
+    static constexpr uint64_t CLOSED = uint64_t{1} << 63;
+
+    // seen_head / seen_tail get the raw value the check was made against, CLOSED bit included
+    bool try_send(Message& msg, uint64_t& seen_head) {
+        uint64_t t = tail.load(std::memory_order_relaxed) & ~CLOSED;
+        uint64_t h = seen_head = head.load(std::memory_order_acquire);
+        if (h & CLOSED) {
+            return true;
+        }
+        if (t - h == slots.size()) {
+            return false;
+        }
+        slots[t & mask] = std::move(msg);
+        tail.store(t + 1, std::memory_order_release);
+        tail.notify_one();
+        return true;
+    }
+
+    bool try_recv(Message& out, uint64_t& seen_tail) {
+        uint64_t h = head.load(std::memory_order_relaxed) & ~CLOSED;
+        seen_tail = tail.load(std::memory_order_acquire);
+        if (h == (seen_tail & ~CLOSED)) {
+            return false;
+        }
+        out = std::move(slots[h & mask]);
+        head.store(h + 1, std::memory_order_release);
+        head.notify_one();
+        return true;
+    }
+
+    std::vector<Message> slots;
+    size_t mask;
+    alignas(64) std::atomic<uint64_t> head{0}; // consumer position, CLOSED once the receiver is gone
+    alignas(64) std::atomic<uint64_t> tail{0}; // producer position, CLOSED once the sender is done
+};
+
+#endif // BLACKBOX_CHANNEL_HPP
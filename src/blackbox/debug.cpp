@@ -53,6 +53,8 @@ const char* opcode_name(uint8_t op) {
             return "JB";
         case Opcode::JAE:
             return "JAE";
+        case Opcode::LOOP:
+            return "LOOP";
         case Opcode::CALL:
             return "CALL";
         case Opcode::RET:
@@ -73,6 +75,58 @@ const char* opcode_name(uint8_t op) {
             return "RESIZE";
         case Opcode::FREE:
             return "FREE";
+        case Opcode::HALLOC:
+            return "HALLOC";
+        case Opcode::HFREE:
+            return "HFREE";
+        case Opcode::LOADB:
+            return "LOADB";
+        case Opcode::LOADW:
+            return "LOADW";
+        case Opcode::LOADD:
+            return "LOADD";
+        case Opcode::LOADSB:
+            return "LOADSB";
+        case Opcode::LOADSW:
+            return "LOADSW";
+        case Opcode::LOADSD:
+            return "LOADSD";
+        case Opcode::ADD3:
+            return "ADD3";
+        case Opcode::SUB3:
+            return "SUB3";
+        case Opcode::MUL3:
+            return "MUL3";
+        case Opcode::DIV3:
+            return "DIV3";
+        case Opcode::MOD3:
+            return "MOD3";
+        case Opcode::AND3:
+            return "AND3";
+        case Opcode::OR3:
+            return "OR3";
+        case Opcode::XOR3:
+            return "XOR3";
+        case Opcode::SHL3:
+            return "SHL3";
+        case Opcode::SHR3:
+            return "SHR3";
+        case Opcode::STOREB:
+            return "STOREB";
+        case Opcode::STOREW:
+            return "STOREW";
+        case Opcode::STORED:
+            return "STORED";
+        case Opcode::HEAPFIND:
+            return "HEAPFIND";
+        case Opcode::MEMCPY:
+            return "MEMCPY";
+        case Opcode::MEMSET:
+            return "MEMSET";
+        case Opcode::MEMCMP:
+            return "MEMCMP";
+        case Opcode::MEMMOVE:
+            return "MEMMOVE";
         case Opcode::WRITE:
             return "WRITE";
         case Opcode::PRINT:
@@ -87,6 +141,46 @@ const char* opcode_name(uint8_t op) {
             return "PRINTSTR";
         case Opcode::EPRINTSTR:
             return "EPRINTSTR";
+        case Opcode::STRCAT:
+            return "STRCAT";
+        case Opcode::STRLEN:
+            return "STRLEN";
+        case Opcode::SUBSTR:
+            return "SUBSTR";
+        case Opcode::STRCMP:
+            return "STRCMP";
+        case Opcode::CHARAT:
+            return "CHARAT";
+        case Opcode::STRFROMHEAP:
+            return "STRFROMHEAP";
+        case Opcode::STRFIND:
+            return "STRFIND";
+        case Opcode::STRCHR:
+            return "STRCHR";
+        case Opcode::STRSPLIT:
+            return "STRSPLIT";
+        case Opcode::ITOA:
+            return "ITOA";
+        case Opcode::ATOI:
+            return "ATOI";
+        case Opcode::STRFMT:
+            return "STRFMT";
+        case Opcode::VADD:
+            return "VADD";
+        case Opcode::VSUB:
+            return "VSUB";
+        case Opcode::VMUL:
+            return "VMUL";
+        case Opcode::VAND:
+            return "VAND";
+        case Opcode::VMIN:
+            return "VMIN";
+        case Opcode::VMAX:
+            return "VMAX";
+        case Opcode::VSUM:
+            return "VSUM";
+        case Opcode::VDOT:
+            return "VDOT";
         case Opcode::PRINTCHAR:
             return "PRINTCHAR";
         case Opcode::EPRINTCHAR:
@@ -105,8 +199,24 @@ const char* opcode_name(uint8_t op) {
             return "FREAD";
         case Opcode::EXEC:
             return "EXEC";
+        case Opcode::EXECX:
+            return "EXECX";
+        case Opcode::EXECBG:
+            return "EXECBG";
+        case Opcode::EXECWAIT:
+            return "EXECWAIT";
         case Opcode::SLEEP:
             return "SLEEP";
+        case Opcode::SCRINIT:
+            return "SCRINIT";
+        case Opcode::SCRPUT:
+            return "SCRPUT";
+        case Opcode::SCRBLIT:
+            return "SCRBLIT";
+        case Opcode::SCRFLUSH:
+            return "SCRFLUSH";
+        case Opcode::RANDFILL:
+            return "RANDFILL";
         case Opcode::RAND:
             return "RAND";
         case Opcode::GETKEY:
@@ -137,6 +247,32 @@ const char* opcode_name(uint8_t op) {
             return "FAULTRET";
         case Opcode::GETFAULT:
             return "GETFAULT";
+        case Opcode::REFUEL:
+            return "REFUEL";
+        case Opcode::GETFUEL:
+            return "GETFUEL";
+        case Opcode::COCREATE:
+            return "COCREATE";
+        case Opcode::YIELD:
+            return "YIELD";
+        case Opcode::RESUME:
+            return "RESUME";
+        case Opcode::CAS:
+            return "CAS";
+        case Opcode::FETCHADD:
+            return "FETCHADD";
+        case Opcode::XCHG:
+            return "XCHG";
+        case Opcode::WAIT:
+            return "WAIT";
+        case Opcode::WAKE:
+            return "WAKE";
+        case Opcode::CHSEND:
+            return "CHSEND";
+        case Opcode::CHRECV:
+            return "CHRECV";
+        case Opcode::CHTRY:
+            return "CHTRY";
         case Opcode::BREAK:
             return "BREAK";
         case Opcode::NOP:
@@ -151,6 +287,20 @@ const char* opcode_name(uint8_t op) {
             return "FWRITE";
         case Opcode::FSEEK:
             return "FSEEK";
+        case Opcode::FCOPY:
+            return "FCOPY";
+        case Opcode::FMAP:
+            return "FMAP";
+        case Opcode::FUNMAP:
+            return "FUNMAP";
+        case Opcode::FREADNB:
+            return "FREADNB";
+        case Opcode::FWRITENB:
+            return "FWRITENB";
+        case Opcode::POLL:
+            return "POLL";
+        case Opcode::PIPE:
+            return "PIPE";
         default:
             return "UNKNOWN";
     }
@@ -17,6 +17,9 @@ enum class FaultType : uint8_t {
     OutOfBounds,
     EnvVarNotFound,
     IllegalOp,
+    Deadlock,
+    FuelExhausted,
+    QuotaExceeded,
     Count // not a real fault
 };
 
@@ -36,6 +39,14 @@ inline std::string_view fault_name(FaultType type) {
             return "OUT_OF_BOUNDS";
         case FaultType::EnvVarNotFound:
             return "ENV_VAR_NOT_FOUND";
+        case FaultType::IllegalOp:
+            return "ILLEGAL_OP";
+        case FaultType::Deadlock:
+            return "DEADLOCK";
+        case FaultType::FuelExhausted:
+            return "FUEL_EXHAUSTED";
+        case FaultType::QuotaExceeded:
+            return "QUOTA_EXCEEDED";
         default:
             return "UNKNOWN";
     }
@@ -0,0 +1,124 @@
+//
+// Created by User on 2026-04-18.
+//
+
+#include "file_copy.hpp"
+#include "reactor.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+
+namespace file_copy {
+namespace {
+// per call cap for the kernel-side copies; they return short counts anyway
+constexpr size_t KERNEL_CHUNK = size_t{1} << 30;
+constexpr size_t BUFFER_SIZE = 256 * 1024;
+
+#ifdef __linux__
+// -1 with errno set when the kernel path cannot handle this pair of fds at all
+template <typename Fn>
+int64_t kernel_copy(Fn&& step, int out_fd, uint64_t max) {
+    uint64_t done = 0;
+    while (done < max) {
+        size_t chunk = static_cast<size_t>(std::min<uint64_t>(max - done, KERNEL_CHUNK));
+        ssize_t n = step(chunk);
+        if (n > 0) {
+            done += static_cast<uint64_t>(n);
+            continue;
+        }
+        if (n == 0) {
+            break;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN) {
+            Reactor::wait_one(out_fd, Reactor::WRITABLE, -1);
+            continue;
+        }
+        if (done == 0 && (errno == EINVAL || errno == EXDEV || errno == ENOSYS ||
+                          errno == EOPNOTSUPP || errno == EBADF || errno == ESPIPE)) {
+            return -1;
+        }
+        break;
+    }
+    return static_cast<int64_t>(done);
+}
+#endif
+} // namespace
+
+bool write_all(int out_fd, std::string_view data) {
+    while (!data.empty()) {
+#ifdef _WIN32
+        int n = _write(out_fd, data.data(), static_cast<unsigned>(std::min<size_t>(data.size(), BUFFER_SIZE)));
+#else
+        ssize_t n = write(out_fd, data.data(), data.size());
+#endif
+        if (n > 0) {
+            data.remove_prefix(static_cast<size_t>(n));
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            Reactor::wait_one(out_fd, Reactor::WRITABLE, -1);
+            continue;
+        }
+        return false;
+    }
+    return true;
+}
+
+int64_t copy(int in_fd, int out_fd, uint64_t max) {
+#ifdef __linux__
+    int64_t n = kernel_copy(
+        [&](size_t chunk) { return copy_file_range(in_fd, nullptr, out_fd, nullptr, chunk, 0); },
+        out_fd, max);
+    if (n >= 0) {
+        return n;
+    }
+    n = kernel_copy([&](size_t chunk) { return sendfile(out_fd, in_fd, nullptr, chunk); }, out_fd,
+                    max);
+    if (n >= 0) {
+        return n;
+    }
+#endif
+
+    std::vector<char> buf(static_cast<size_t>(std::min<uint64_t>(max, BUFFER_SIZE)));
+    uint64_t done = 0;
+    while (done < max) {
+        size_t want = static_cast<size_t>(std::min<uint64_t>(max - done, buf.size()));
+#ifdef _WIN32
+        int got = _read(in_fd, buf.data(), static_cast<unsigned>(want));
+#else
+        ssize_t got = read(in_fd, buf.data(), want);
+#endif
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            // end of input, or a non-blocking source that is empty for now
+            if (got < 0 && done == 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                return -1;
+            }
+            break;
+        }
+        if (!write_all(out_fd, std::string_view(buf.data(), static_cast<size_t>(got)))) {
+            return -1;
+        }
+        done += static_cast<uint64_t>(got);
+    }
+    return static_cast<int64_t>(done);
+}
+
+} // namespace file_copy
@@ -0,0 +1,24 @@
+//
+// Created by User on 2026-04-18.
+//
+
+#ifndef BLACKBOX_FILE_COPY_HPP
+#define BLACKBOX_FILE_COPY_HPP
+
+#include <cstdint>
+#include <string_view>
+
+// FCOPY backend: moves bytes between two OS descriptors at their current file positions, which
+// are advanced. tries copy_file_range, then sendfile, then a read/write loop
+namespace file_copy {
+
+// copies until end of input or max bytes. stops early without error when a non-blocking
+// source has nothing more to read. returns the bytes copied, or -1 if nothing could be copied
+int64_t copy(int in_fd, int out_fd, uint64_t max);
+
+// writes all of data, waiting while a non-blocking destination is full. false on error
+bool write_all(int out_fd, std::string_view data);
+
+} // namespace file_copy
+
+#endif // BLACKBOX_FILE_COPY_HPP
@@ -0,0 +1,233 @@
+//
+// Created by User on 2026-04-18.
+//
+
+#include "heap.hpp"
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+// heap addresses are 32-bit, so 2^32 slots is all the address space the heap can ever use
+constexpr uint64_t MAX_BYTES = (uint64_t{1} << 32) * sizeof(int64_t);
+constexpr uint64_t MIN_RESERVE = uint64_t{64} << 20;
+constexpr size_t COMMIT_CHUNK = 64 * 1024;
+
+size_t page_size() {
+#ifdef _WIN32
+    static const size_t size = [] {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return static_cast<size_t>(info.dwAllocationGranularity);
+    }();
+#else
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+    return size;
+}
+
+size_t round_up(size_t n, size_t align) {
+    return (n + align - 1) / align * align;
+}
+
+// 32 GiB of address space on 64-bit hosts
+uint64_t max_reserve() {
+    return std::min<uint64_t>(MAX_BYTES, SIZE_MAX / 2 + 1);
+}
+
+void* reserve_region(size_t bytes) {
+#ifdef _WIN32
+    return VirtualAlloc(nullptr, bytes, MEM_RESERVE, PAGE_NOACCESS);
+#else
+    void* p = mmap(nullptr, bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    return p == MAP_FAILED ? nullptr : p;
+#endif
+}
+
+bool commit_region(void* at, size_t bytes) {
+#ifdef _WIN32
+    return VirtualAlloc(at, bytes, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+#else
+    return mprotect(at, bytes, PROT_READ | PROT_WRITE) == 0;
+#endif
+}
+
+void release_region(void* p, size_t bytes) {
+#ifdef _WIN32
+    (void) bytes;
+    VirtualFree(p, 0, MEM_RELEASE);
+#else
+    munmap(p, bytes);
+#endif
+}
+} // namespace
+
+Heap::~Heap() {
+    if (slots) {
+        release_region(slots, reserved);
+    }
+}
+
+size_t Heap::capacity() const {
+    return static_cast<size_t>((final_region ? reserved : max_reserve()) / sizeof(int64_t));
+}
+
+// copies the slots into a new reservation of want bytes, halving want until the OS agrees (32-bit
+// hosts, ulimit -v). false, with nothing changed, when not even min_bytes can be had
+bool Heap::move_to(uint64_t want, uint64_t min_bytes) {
+    void* p = nullptr;
+    for (; want >= min_bytes; want /= 2) {
+        if ((p = reserve_region(static_cast<size_t>(want)))) {
+            break;
+        }
+    }
+    if (!p) {
+        return false;
+    }
+    if (committed > 0) {
+        if (!commit_region(p, committed)) {
+            release_region(p, static_cast<size_t>(want));
+            return false;
+        }
+        std::memcpy(p, slots, count * sizeof(int64_t));
+        release_region(slots, reserved);
+    }
+    slots = static_cast<int64_t*>(p);
+    reserved = static_cast<size_t>(want);
+    return true;
+}
+
+void Heap::commit(size_t n) {
+    if (n > capacity()) {
+        throw std::bad_alloc();
+    }
+    if (n * sizeof(int64_t) > reserved) {
+        // only reached before the first FMAP, so there are no windows to keep in place
+        uint64_t need = round_up(n * sizeof(int64_t), page_size());
+        uint64_t want = std::max({MIN_RESERVE, uint64_t{reserved} * 2, std::bit_ceil(need)});
+        if (!move_to(std::min(want, max_reserve()), need)) {
+            throw std::bad_alloc();
+        }
+    }
+    size_t target = round_up(n * sizeof(int64_t), COMMIT_CHUNK);
+    target = std::min(std::max(target, committed * 2), reserved);
+    if (!commit_region(reinterpret_cast<char*>(slots) + committed, target - committed)) {
+        throw std::bad_alloc();
+    }
+    committed = target;
+}
+
+void Heap::resize(size_t n, int64_t value) {
+    if (n > count) {
+        if (n > committed_slots()) {
+            commit(n);
+        }
+        std::fill(slots + count, slots + n, value);
+    } else {
+        std::erase_if(windows, [&](const Window& w) {
+            if (w.base + w.slots <= n) {
+                return false;
+            }
+            drop_window(w);
+            return true;
+        });
+    }
+    count = n;
+}
+
+size_t Heap::map_end(uint64_t bytes) const {
+    size_t base = round_up(count * sizeof(int64_t), page_size()) / sizeof(int64_t);
+    return base + static_cast<size_t>((bytes + sizeof(int64_t) - 1) / sizeof(int64_t));
+}
+
+std::optional<size_t> Heap::map_file(int os_fd, uint64_t bytes) {
+    if (!final_region) {
+        // windows cannot move, so take all the address space now. when the OS will not give more
+        // than is already reserved, the current region becomes the final one
+        move_to(max_reserve(), std::max<uint64_t>(MIN_RESERVE, uint64_t{reserved} + 1));
+        final_region = true;
+    }
+    size_t page = page_size();
+    size_t base_bytes = round_up(count * sizeof(int64_t), page);
+    size_t base = base_bytes / sizeof(int64_t);
+    if (bytes > reserved - base_bytes) {
+        return std::nullopt;
+    }
+    size_t n = static_cast<size_t>((bytes + sizeof(int64_t) - 1) / sizeof(int64_t));
+    size_t map_bytes = round_up(static_cast<size_t>(bytes), page);
+
+    if (base > committed_slots()) {
+        commit(base);
+    }
+    std::fill(slots + count, slots + base, 0);
+
+#ifdef _WIN32
+    // a view cannot be placed inside a reserved region, so Windows reads the file instead
+    if (base + n > committed_slots()) {
+        commit(base + n);
+    }
+    std::memset(slots + base, 0, n * sizeof(int64_t));
+    _lseeki64(os_fd, 0, SEEK_SET);
+    auto* dst = reinterpret_cast<char*>(slots + base);
+    for (uint64_t done = 0; done < bytes;) {
+        int got = _read(os_fd, dst + done, static_cast<unsigned>(std::min<uint64_t>(bytes - done, 1u << 30)));
+        if (got <= 0) {
+            break;
+        }
+        done += static_cast<uint64_t>(got);
+    }
+    (void)map_bytes;
+#else
+    if (map_bytes > 0) {
+        void* at = reinterpret_cast<char*>(slots) + base_bytes;
+        if (mmap(at, map_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, os_fd, 0) == MAP_FAILED) {
+            // MAP_FIXED failing leaves the range unmapped; put ordinary pages back
+            mmap(at, map_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+            return std::nullopt;
+        }
+        committed = std::max(committed, base_bytes + map_bytes);
+    }
+#endif
+
+    windows.push_back(Window{.base = base, .slots = n, .prev_size = count});
+    count = base + n;
+    return base;
+}
+
+std::optional<size_t> Heap::unmap(size_t base) {
+    auto it = std::find_if(windows.begin(), windows.end(),
+                           [&](const Window& w) { return w.base == base; });
+    if (it == windows.end()) {
+        return std::nullopt;
+    }
+    Window w = *it;
+    windows.erase(it);
+    drop_window(w);
+    if (w.base + w.slots == count) {
+        count = w.prev_size;
+    }
+    return w.slots;
+}
+
+void Heap::drop_window(const Window& w) {
+#ifdef _WIN32
+    std::memset(slots + w.base, 0, w.slots * sizeof(int64_t));
+#else
+    size_t bytes = round_up(w.slots * sizeof(int64_t), page_size());
+    if (bytes > 0) {
+        mmap(slots + w.base, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED,
+             -1, 0);
+    }
+#endif
+}
@@ -0,0 +1,100 @@
+//
+// Created by User on 2026-04-18.
+//
+
+#ifndef BLACKBOX_HEAP_HPP
+#define BLACKBOX_HEAP_HPP
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// the VM heap (op_stack). slots live in a reserved virtual region that is committed as the heap
+// grows. until the first FMAP the region is only as large as the heap needs and moves to a bigger
+// one when outgrown, like a vector; the first FMAP reserves all the address space the heap may
+// ever use, so the windows it maps never move. the interface is the part of std::vector the VM
+// uses
+class Heap {
+  public:
+    Heap() = default;
+    ~Heap();
+
+    Heap(const Heap&) = delete;
+    Heap& operator=(const Heap&) = delete;
+
+    size_t size() const { return count; }
+    // slots the heap can grow to; resize past it throws
+    size_t capacity() const;
+    bool empty() const { return count == 0; }
+    int64_t* data() { return slots; }
+    const int64_t* data() const { return slots; }
+    int64_t& operator[](size_t i) { return slots[i]; }
+    const int64_t& operator[](size_t i) const { return slots[i]; }
+    int64_t& back() { return slots[count - 1]; }
+
+    // throws std::bad_alloc past capacity() or when the OS refuses the memory. shrinking drops any
+    // mapped window that no longer fits
+    void resize(size_t n, int64_t value = 0);
+    void push_back(int64_t v) {
+        if (count == committed_slots()) {
+            commit(count + 1);
+        }
+        slots[count++] = v;
+    }
+    // popping into a mapped window drops it, as resize does
+    void pop_back() {
+        if (windows.empty()) {
+            count--;
+        } else {
+            resize(count - 1);
+        }
+    }
+
+    // maps bytes of a file read-only (copy-on-write, so stray writes cannot fault the host) at the
+    // first page-aligned slot at or past size(), packed 8 bytes per slot, little-endian. the heap
+    // grows to cover it; the padding before it reads as zero. returns the first slot
+    std::optional<size_t> map_file(int os_fd, uint64_t bytes);
+
+    // the size() map_file(bytes) would leave, padding included
+    size_t map_end(uint64_t bytes) const;
+
+    // turns a mapped window back into ordinary zeroed slots, shrinking the heap to where it was
+    // before the mapping when the window is at the top. returns the slot count, or nullopt when
+    // base does not start a window
+    std::optional<size_t> unmap(size_t base);
+
+    // calls fn(first, count) for each run of slots outside the mapped windows, in address order
+    template <typename Fn> void for_each_owned(Fn&& fn) const {
+        size_t at = 0;
+        for (const Window& w : windows) {
+            if (w.base > at) {
+                fn(at, w.base - at);
+            }
+            at = w.base + w.slots;
+        }
+        if (count > at) {
+            fn(at, count - at);
+        }
+    }
+
+  private:
+    struct Window {
+        size_t base;
+        size_t slots;
+        size_t prev_size; // heap size before the mapping
+    };
+
+    int64_t* slots = nullptr;
+    size_t count = 0;
+    size_t committed = 0; // bytes
+    size_t reserved = 0;  // bytes
+    bool final_region = false; // reserved by the first FMAP; never moves again
+    std::vector<Window> windows; // ascending by base
+
+    size_t committed_slots() const { return committed / sizeof(int64_t); }
+    void commit(size_t n);
+    bool move_to(uint64_t want, uint64_t min_bytes);
+    void drop_window(const Window& w);
+};
+
+#endif // BLACKBOX_HEAP_HPP
@@ -0,0 +1,130 @@
+//
+// Created by User on 2026-04-18.
+//
+
+#include "input_buffer.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+bool InputBuffer::fill() {
+    if (pos > 0) {
+        std::memmove(buf.data(), buf.data() + pos, end - pos);
+        end -= pos;
+        pos = 0;
+    }
+    for (;;) {
+#ifdef _WIN32
+        int n = _read(fd, buf.data() + end, static_cast<unsigned>(buf.size() - end));
+#else
+        ssize_t n = read(fd, buf.data() + end, buf.size() - end);
+#endif
+        if (n > 0) {
+            blocked = false;
+            end += static_cast<size_t>(n);
+            return true;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        blocked = n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+        return false;
+    }
+}
+
+bool InputBuffer::read_int(int64_t& out) {
+    int c;
+    while ((c = peek()) != END && (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' ||
+                                   c == '\f')) {
+        pos++;
+    }
+    if (c == END) {
+        return false;
+    }
+
+    bool negative = false;
+    if (c == '+' || c == '-') {
+        // a sign only counts when a digit follows; otherwise leave it for skip_line
+        if (pos + 1 == end) {
+            fill();
+        }
+        if (pos + 1 == end || buf[pos + 1] < '0' || buf[pos + 1] > '9') {
+            return false;
+        }
+        negative = c == '-';
+        pos++;
+    } else if (c < '0' || c > '9') {
+        return false;
+    }
+
+    // accumulate as a negative number so INT64_MIN is representable
+    constexpr int64_t MIN = std::numeric_limits<int64_t>::min();
+    int64_t value = 0;
+    bool overflow = false;
+    while ((c = peek()) != END && c >= '0' && c <= '9') {
+        int digit = c - '0';
+        if (value < (MIN + digit) / 10) {
+            overflow = true;
+        } else {
+            value = value * 10 - digit;
+        }
+        pos++;
+    }
+    if (overflow) {
+        out = negative ? MIN : std::numeric_limits<int64_t>::max();
+    } else if (negative) {
+        out = value;
+    } else {
+        out = value == MIN ? std::numeric_limits<int64_t>::max() : -value;
+    }
+    return true;
+}
+
+bool InputBuffer::read_line(std::string& out) {
+    out.clear();
+    bool any = false;
+    for (;;) {
+        if (pos == end && !fill()) {
+            return any;
+        }
+        any = true;
+        const char* start = buf.data() + pos;
+        const char* nl = static_cast<const char*>(std::memchr(start, '\n', end - pos));
+        if (nl) {
+            out.append(start, nl);
+            pos += static_cast<size_t>(nl - start) + 1;
+            return true;
+        }
+        out.append(start, end - pos);
+        pos = end;
+    }
+}
+
+void InputBuffer::skip_line() {
+    for (;;) {
+        if (pos == end && !fill()) {
+            return;
+        }
+        const char* start = buf.data() + pos;
+        const char* nl = static_cast<const char*>(std::memchr(start, '\n', end - pos));
+        if (nl) {
+            pos += static_cast<size_t>(nl - start) + 1;
+            return;
+        }
+        pos = end;
+    }
+}
+
+size_t InputBuffer::take(std::string& out, size_t max) {
+    size_t n = std::min(max, end - pos);
+    out.append(buf.data() + pos, n);
+    pos += n;
+    return n;
+}
@@ -0,0 +1,64 @@
+//
+// Created by User on 2026-04-18.
+//
+
+#ifndef BLACKBOX_INPUT_BUFFER_HPP
+#define BLACKBOX_INPUT_BUFFER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// buffered reader over a raw file descriptor. all of a VM's stdin traffic (READ, READSTR,
+// READCHAR, FREAD on stdin, GETKEY) goes through one of these so nothing is lost between
+// stdio, iostreams and direct reads
+class InputBuffer {
+  public:
+    static constexpr int END = -1;
+
+    explicit InputBuffer(int fd, size_t capacity = 64 * 1024) : fd(fd), buf(capacity) {}
+
+    // bytes are waiting in the buffer, so the next get() will not touch the fd
+    bool buffered() const { return pos < end; }
+
+    // the last END came from a non-blocking fd with nothing to read yet, not from end of input
+    bool would_block() const { return blocked; }
+
+    int get() {
+        if (pos == end && !fill()) {
+            return END;
+        }
+        return static_cast<unsigned char>(buf[pos++]);
+    }
+
+    int peek() {
+        if (pos == end && !fill()) {
+            return END;
+        }
+        return static_cast<unsigned char>(buf[pos]);
+    }
+
+    // skips whitespace (newlines included), then reads an optionally signed decimal. saturates on
+    // overflow. false without consuming anything past the whitespace when no digits follow
+    bool read_int(int64_t& out);
+
+    // reads up to the next '\n', which is consumed but not stored. false at end of input
+    bool read_line(std::string& out);
+
+    // drops everything up to and including the next '\n'
+    void skip_line();
+
+    // moves up to max already-buffered bytes into out without touching the fd
+    size_t take(std::string& out, size_t max);
+
+  private:
+    int fd;
+    std::vector<char> buf;
+    size_t pos = 0, end = 0;
+    bool blocked = false;
+
+    // moves unread bytes to the front and appends one read(); false on end of input or error
+    bool fill();
+};
+
+#endif // BLACKBOX_INPUT_BUFFER_HPP
@@ -1,15 +1,117 @@
 //
 // Created by User on 2026-04-18.
 //
+#include "channel.hpp"
 #include "debugger.hpp"
 #include "program.hpp"
 #include "vm.hpp"
+#include <charconv>
+#include <cstdint>
 #include <filesystem>
+#include <memory>
+#include <optional>
 #include <print>
 #include <string_view>
+#include <thread>
+#include <vector>
 namespace {
 void print_usage() {
-    std::println("Usage: bbx [--debug|-d] [--step|-s] <program.bcx>");
+    std::println("Usage: bbx [--debug|-d] [--step|-s] [options] <program.bcx>");
+    std::println("       bbx [options] --pipeline <stage1.bcx> <stage2.bcx> [...]");
+    std::println("Options: --fuel N         backward jumps and calls before FUEL_EXHAUSTED");
+    std::println("         --max-heap N     heap slots");
+    std::println("         --max-frames N   frame slots across all coroutines");
+    std::println("         --max-strings N  string table bytes");
+    std::println("         --seed N         fixed RAND seed for reproducible runs");
+    std::println("         --stats          print memory usage to stderr on exit");
+}
+
+// host-side limits applied to every VM this process starts
+struct RunOptions {
+    std::optional<uint64_t> fuel;
+    std::optional<uint64_t> seed;
+    VM::Limits limits;
+    bool stats = false;
+};
+
+void apply_options(VM& vm, const RunOptions& options) {
+    if (options.fuel) {
+        vm.set_fuel(*options.fuel);
+    }
+    if (options.seed) {
+        vm.set_seed(*options.seed);
+    }
+    vm.set_limits(options.limits);
+}
+
+void print_stats(const VM& vm, std::string_view name) {
+    auto s = vm.memory_stats();
+    std::println(stderr,
+                 "[{}] heap: {} slots ({} bytes), frames: {} slots ({} bytes), strings: {} ({} bytes, "
+                 "{} collections)",
+                 name, s.heap_slots, s.heap_bytes, s.frame_slots, s.frame_bytes, s.string_count,
+                 s.string_bytes, s.string_collections);
+    if (s.allocator.allocations != 0) {
+        std::println(stderr,
+                     "[{}] halloc: {} blocks ({} slots) live, {} slots free, {} allocations, {} "
+                     "frees",
+                     name, s.allocator.live_blocks, s.allocator.live_slots, s.allocator.free_slots,
+                     s.allocator.allocations, s.allocator.releases);
+    }
+}
+
+std::optional<uint64_t> parse_u64(std::string_view text) {
+    uint64_t value = 0;
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc{} || ptr != text.data() + text.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+// every stage runs on its own thread; stage i sends on channel 1 and stage i+1 receives on
+// channel 0
+int run_pipeline(const std::vector<std::filesystem::path>& paths, const RunOptions& options,
+                 int argc, char** argv) {
+    std::vector<std::unique_ptr<VM>> stages;
+    for (const auto& path : paths) {
+        auto result = Program::load(path);
+        if (!result) {
+            std::println(stderr, "Error loading '{}': {}", path.string(), result.error());
+            return 1;
+        }
+        stages.push_back(std::make_unique<VM>(std::move(*result), argc, argv));
+        apply_options(*stages.back(), options);
+    }
+
+    for (size_t i = 0; i + 1 < stages.size(); i++) {
+        auto channel = std::make_shared<Channel>();
+        stages[i]->attach_channel(1, channel, true);
+        stages[i + 1]->attach_channel(0, channel, false);
+    }
+
+    std::vector<int> exit_codes(stages.size(), 0);
+    std::vector<std::thread> threads;
+    threads.reserve(stages.size());
+    for (size_t i = 0; i < stages.size(); i++) {
+        threads.emplace_back([&, i] { exit_codes[i] = stages[i]->run(); });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    if (options.stats) {
+        for (size_t i = 0; i < stages.size(); i++) {
+            print_stats(*stages[i], paths[i].filename().string());
+        }
+    }
+
+    for (int code : exit_codes) {
+        if (code != 0) {
+            return code;
+        }
+    }
+    return 0;
 }
 } // namespace
 
@@ -20,12 +122,42 @@ int main(int argc, char** argv) {
     }
 
     std::filesystem::path prog_path;
+    std::vector<std::filesystem::path> pipeline;
     bool debug = false;
     bool step_mode = false;
+    RunOptions options;
 
     for (int i = 1; i < argc; i++) {
         std::string_view arg(argv[i]);
-        if (arg == "--debug" || arg == "-d") {
+        if (arg == "--pipeline") {
+            for (i++; i < argc; i++) {
+                pipeline.emplace_back(argv[i]);
+            }
+        } else if (arg == "--fuel" || arg == "--seed" || arg == "--max-heap" || arg == "--max-frames" ||
+                   arg == "--max-strings") {
+            std::optional<uint64_t> value;
+            if (i + 1 < argc) {
+                value = parse_u64(argv[++i]);
+            }
+            if (!value) {
+                std::println(stderr, "{} expects a non-negative number", arg);
+                print_usage();
+                return 1;
+            }
+            if (arg == "--fuel") {
+                options.fuel = value;
+            } else if (arg == "--seed") {
+                options.seed = value;
+            } else if (arg == "--max-heap") {
+                options.limits.heap_slots = *value;
+            } else if (arg == "--max-frames") {
+                options.limits.frame_slots = *value;
+            } else {
+                options.limits.string_bytes = *value;
+            }
+        } else if (arg == "--stats") {
+            options.stats = true;
+        } else if (arg == "--debug" || arg == "-d") {
             debug = true;
         } else if (arg == "--step" || arg == "-s") {
             debug = true;
@@ -39,6 +171,15 @@ int main(int argc, char** argv) {
         }
     }
 
+    if (!pipeline.empty()) {
+        if (debug || !prog_path.empty()) {
+            std::println(stderr, "--pipeline cannot be combined with a program or the debugger");
+            print_usage();
+            return 1;
+        }
+        return run_pipeline(pipeline, options, argc, argv);
+    }
+
     if (prog_path.empty()) {
         print_usage();
         return 1;
@@ -51,6 +192,7 @@ int main(int argc, char** argv) {
     }
 
     VM vm(std::move(*result), argc, argv);
+    apply_options(vm, options);
 
     if (debug) {
         Debugger::Mode mode = step_mode ? Debugger::Mode::Step : Debugger::Mode::Breakpoint;
@@ -58,5 +200,9 @@ int main(int argc, char** argv) {
         return dbg.run();
     }
 
-    return vm.run();
+    int code = vm.run();
+    if (options.stats) {
+        print_stats(vm, prog_path.filename().string());
+    }
+    return code;
 }
@@ -40,4 +40,39 @@ void VM::op_inc() {
 void VM::op_dec() {
     auto& dst = fetch_writable();
     dst--;
+}
+
+// three-operand forms: dst = a op b, so neither source has to be copied into dst first
+void VM::op_add3() {
+    auto& dst = fetch_writable();
+    int64_t a = read_operand();
+    dst = a + read_operand();
+}
+void VM::op_sub3() {
+    auto& dst = fetch_writable();
+    int64_t a = read_operand();
+    dst = a - read_operand();
+}
+void VM::op_mul3() {
+    auto& dst = fetch_writable();
+    int64_t a = read_operand();
+    dst = a * read_operand();
+}
+void VM::op_div3() {
+    auto& dst = fetch_writable();
+    int64_t a = read_operand();
+    int64_t b = read_operand();
+    if (b == 0) {
+        raise_fault(FaultType::DivZero, std::format("division by zero at pc={}", pc));
+    }
+    dst = a / b;
+}
+void VM::op_mod3() {
+    auto& dst = fetch_writable();
+    int64_t a = read_operand();
+    int64_t b = read_operand();
+    if (b == 0) {
+        raise_fault(FaultType::DivZero, std::format("modulo by zero at pc={}", pc));
+    }
+    dst = a % b;
 }
\ No newline at end of file
@@ -0,0 +1,82 @@
+//
+// Created by User on 2026-04-18.
+//
+
+#include "ops_atomic.hpp"
+#include "../vm.hpp"
+#include <atomic>
+#include <format>
+
+// heap slots are accessed through std::atomic_ref so the sequentially consistent
+// semantics hold even when the heap is touched from more than one thread
+
+void VM::op_cas() {
+    int64_t& slot = fetch_atomic_slot("CAS");
+    size_t exp_reg = fetch_reg();
+    int64_t desired = read_operand();
+
+    int64_t expected = regs[exp_reg];
+    bool swapped = std::atomic_ref<int64_t>(slot).compare_exchange_strong(expected, desired);
+    // on failure the register receives the value that was observed
+    regs[exp_reg] = expected;
+    ZF = swapped ? 1 : 0;
+}
+
+void VM::op_fetchadd() {
+    size_t dst = fetch_reg();
+    int64_t& slot = fetch_atomic_slot("FETCHADD");
+    int64_t delta = read_operand();
+    regs[dst] = std::atomic_ref<int64_t>(slot).fetch_add(delta);
+}
+
+void VM::op_xchg() {
+    size_t reg = fetch_reg();
+    int64_t& slot = fetch_atomic_slot("XCHG");
+    regs[reg] = std::atomic_ref<int64_t>(slot).exchange(regs[reg]);
+}
+
+void VM::op_wait() {
+    int64_t& slot = fetch_atomic_slot("WAIT");
+    uint32_t addr = static_cast<uint32_t>(&slot - op_stack.data());
+    int64_t expected = read_operand();
+
+    if (std::atomic_ref<int64_t>(slot).load() != expected) {
+        return;
+    }
+
+    Coroutine& co = coroutines[cur_co];
+    co.state = Coroutine::State::Waiting;
+    co.wait_addr = addr;
+    waiters[addr].push_back(cur_co);
+    if (!schedule()) {
+        cancel_wait(cur_co);
+        co.state = Coroutine::State::Running;
+        hard_fault(FaultType::Deadlock,
+                   std::format("WAIT on slot {} with no other coroutine to wake it at pc={}", addr,
+                               pc));
+    }
+}
+
+void VM::op_wake() {
+    int64_t& slot = fetch_atomic_slot("WAKE");
+    uint32_t addr = static_cast<uint32_t>(&slot - op_stack.data());
+    int64_t count = read_operand();
+
+    auto it = waiters.find(addr);
+    if (it == waiters.end()) {
+        return;
+    }
+    // a negative count wakes every waiter
+    auto& queue = it->second;
+    int64_t woken = 0;
+    while (!queue.empty() && (count < 0 || woken < count)) {
+        size_t id = queue.front();
+        queue.pop_front();
+        coroutines[id].state = Coroutine::State::Ready;
+        run_queue.push_back(id);
+        ++woken;
+    }
+    if (queue.empty()) {
+        waiters.erase(it);
+    }
+}
@@ -41,3 +41,36 @@ void VM::op_shr() {
     }
     regs[dst] >>= shift;
 }
+
+void VM::op_and3() {
+    auto& dst = fetch_writable();
+    int64_t a = read_operand();
+    dst = a & read_operand();
+}
+void VM::op_or3() {
+    auto& dst = fetch_writable();
+    int64_t a = read_operand();
+    dst = a | read_operand();
+}
+void VM::op_xor3() {
+    auto& dst = fetch_writable();
+    int64_t a = read_operand();
+    dst = a ^ read_operand();
+}
+// shift counts outside [0, 64) behave as in SHL and SHR
+void VM::op_shl3() {
+    auto& dst = fetch_writable();
+    int64_t a = read_operand();
+    int64_t shift = read_operand();
+    dst = shift < 0 || shift >= 64 ? 0 : a << shift;
+}
+void VM::op_shr3() {
+    auto& dst = fetch_writable();
+    int64_t a = read_operand();
+    int64_t shift = read_operand();
+    if (shift < 0 || shift >= 64) {
+        dst = a < 0 ? -1 : 0;
+        return;
+    }
+    dst = a >> shift;
+}
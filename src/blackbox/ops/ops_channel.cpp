@@ -0,0 +1,67 @@
+//
+// Created by User on 2026-04-18.
+//
+
+#include "ops_channel.hpp"
+#include "../vm.hpp"
+#include <format>
+
+void VM::op_chsend() {
+    uint8_t id = fetch_u8();
+    uint8_t flags = fetch_u8();
+    int64_t value = read_operand();
+    Channel& ch = channel_port(id, true, "CHSEND");
+
+    Channel::Message msg;
+    if (flags & CHANNEL_STRING) {
+        msg.text = std::string(string_at(value, "CHSEND"));
+        msg.is_string = true;
+    } else {
+        msg.value = value;
+    }
+
+    if (ch.try_send(msg)) {
+        return;
+    }
+    if (yield_to_retry()) {
+        return;
+    }
+    ch.send(std::move(msg));
+}
+
+void VM::op_chrecv() {
+    size_t dst = fetch_reg();
+    uint8_t id = fetch_u8();
+    Channel& ch = channel_port(id, false, "CHRECV");
+
+    Channel::Message msg;
+    if (!ch.try_recv(msg)) {
+        if (!ch.drained() && yield_to_retry()) {
+            return;
+        }
+        if (!ch.recv(msg)) {
+            regs[dst] = -1;
+            ZF = 1;
+            return;
+        }
+    }
+    regs[dst] = msg.is_string ? intern_string(msg.text) : msg.value;
+    ZF = 0;
+}
+
+void VM::op_chtry() {
+    size_t dst = fetch_reg();
+    uint8_t id = fetch_u8();
+    Channel& ch = channel_port(id, false, "CHTRY");
+
+    Channel::Message msg;
+    if (!ch.try_recv(msg)) {
+        regs[dst] = -1;
+        ZF = 1;
+        CF = ch.drained() ? 1 : 0;
+        return;
+    }
+    regs[dst] = msg.is_string ? intern_string(msg.text) : msg.value;
+    ZF = 0;
+    CF = 0;
+}
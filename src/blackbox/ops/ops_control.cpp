@@ -13,6 +13,9 @@ void VM::op_jmp() {
                    std::format("JMP address {} out of bounds at pc={}", addr, pc));
     }
     pc = static_cast<size_t>(addr);
+    if (pc <= instr_pc) {
+        charge_fuel();
+    }
 }
 
 void VM::op_je() {
@@ -23,6 +26,9 @@ void VM::op_je() {
                        std::format("JE address {} out of bounds at pc={}", addr, pc));
         }
         pc = addr;
+        if (pc <= instr_pc) {
+            charge_fuel();
+        }
     }
 }
 
@@ -34,6 +40,9 @@ void VM::op_jne() {
                        std::format("JNE address {} out of bounds at pc={}", addr, pc));
         }
         pc = addr;
+        if (pc <= instr_pc) {
+            charge_fuel();
+        }
     }
 }
 
@@ -45,6 +54,9 @@ void VM::op_jl() {
                        std::format("JL address {} out of bounds at pc={}", addr, pc));
         }
         pc = addr;
+        if (pc <= instr_pc) {
+            charge_fuel();
+        }
     }
 }
 
@@ -56,6 +68,9 @@ void VM::op_jge() {
                        std::format("JGE address {} out of bounds at pc={}", addr, pc));
         }
         pc = addr;
+        if (pc <= instr_pc) {
+            charge_fuel();
+        }
     }
 }
 
@@ -67,6 +82,9 @@ void VM::op_jb() {
                        std::format("JB address {} out of bounds at pc={}", addr, pc));
         }
         pc = addr;
+        if (pc <= instr_pc) {
+            charge_fuel();
+        }
     }
 }
 
@@ -78,6 +96,33 @@ void VM::op_jae() {
                        std::format("JAE address {} out of bounds at pc={}", addr, pc));
         }
         pc = addr;
+        if (pc <= instr_pc) {
+            charge_fuel();
+        }
+    }
+}
+
+// counter += step, then jump while the counter has not passed limit: counter <= limit for a
+// non-negative step, counter >= limit for a negative one. a counter that overflows has passed
+void VM::op_loop() {
+    auto& counter = fetch_writable();
+    int64_t step = read_operand();
+    int64_t limit = read_operand();
+    uint32_t addr = fetch_u32();
+
+    auto next = static_cast<int64_t>(static_cast<uint64_t>(counter) + static_cast<uint64_t>(step));
+    bool overflow = step >= 0 ? next < counter : next > counter;
+    counter = next;
+    if (overflow || (step >= 0 ? next > limit : next < limit)) {
+        return;
+    }
+    if (addr >= prog.code.size()) {
+        hard_fault(FaultType::OutOfBounds,
+                   std::format("LOOP address {} out of bounds at pc={}", addr, pc));
+    }
+    pc = addr;
+    if (pc <= instr_pc) {
+        charge_fuel();
     }
 }
 
@@ -90,9 +135,15 @@ void VM::op_call() {
     }
     push_frame(frame_size, pc);
     pc = addr;
+    charge_fuel();
 }
 
 void VM::op_ret() {
+    // returning from a coroutine's entry frame ends the coroutine
+    if (cur_co != 0 && call_stack.size() == 1) {
+        finish_coroutine();
+        return;
+    }
     pop_frame();
 }
 
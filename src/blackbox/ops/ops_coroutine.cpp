@@ -0,0 +1,80 @@
+//
+// Created by User on 2026-04-18.
+//
+
+#include "ops_coroutine.hpp"
+#include "../vm.hpp"
+#include <algorithm>
+#include <format>
+
+void VM::op_cocreate() {
+    size_t dst = fetch_reg();
+    uint32_t addr = fetch_u32();
+    uint32_t frame_size = fetch_u32();
+    if (addr >= prog.code.size()) {
+        hard_fault(FaultType::OutOfBounds,
+                   std::format("COCREATE address {} out of bounds at pc={}", addr, pc));
+    }
+    check_frame_quota(frame_size, "COCREATE");
+
+    size_t id;
+    if (!free_coroutines.empty()) {
+        id = free_coroutines.back();
+        free_coroutines.pop_back();
+    } else {
+        id = coroutines.size();
+        coroutines.emplace_back();
+    }
+
+    // starts with a copy of the creator's registers and a single frame; RET from it ends it
+    Coroutine& co = coroutines[id];
+    co.state = Coroutine::State::Ready;
+    co.pc = addr;
+    co.regs = regs;
+    co.ZF = co.CF = co.SF = co.OF = co.AF = co.PF = 0;
+    co.call_stack.clear();
+    co.call_stack.push_back(Frame{.ret_pc = pc, .frame_base = 0});
+    co.mem.assign(frame_size, 0);
+    co.mem_top = frame_size;
+    frame_slots_used += frame_size;
+
+    ++live_coroutines;
+    run_queue.push_back(id);
+    regs[dst] = static_cast<int64_t>(id);
+    // charged once the coroutine exists, so FAULTRET after a refuel does not create it twice
+    charge_fuel();
+}
+
+void VM::op_yield() {
+    yield_current();
+}
+
+void VM::op_resume() {
+    size_t r = fetch_reg();
+    int64_t id = regs[r];
+    if (id < 0 || static_cast<size_t>(id) >= coroutines.size()) {
+        hard_fault(FaultType::OutOfBounds,
+                   std::format("RESUME invalid coroutine {} at pc={}", id, pc));
+    }
+    size_t target = static_cast<size_t>(id);
+    Coroutine& co = coroutines[target];
+    if (co.state == Coroutine::State::Free) {
+        ZF = 1;
+        return;
+    }
+    ZF = 0;
+    if (target == cur_co) {
+        return;
+    }
+
+    if (co.state == Coroutine::State::Ready) {
+        run_queue.erase(std::find(run_queue.begin(), run_queue.end(), target));
+    } else if (co.state == Coroutine::State::Sleeping) {
+        ++co.wake_seq;
+    } else if (co.state == Coroutine::State::Waiting) {
+        cancel_wait(target);
+    }
+    coroutines[cur_co].state = Coroutine::State::Ready;
+    run_queue.push_back(cur_co);
+    switch_to(target);
+}
@@ -3,11 +3,23 @@
 //
 
 #include "ops_io.hpp"
+#include "../file_copy.hpp"
+#include "../terminal.hpp"
 #include "../vm.hpp"
+#include <algorithm>
+#include <cstdio>
 #include <format>
 #include <iostream>
 #include <print>
 
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 
 void VM::op_print() {
     uint8_t val = fetch_u8();
@@ -51,22 +63,12 @@ void VM::op_loadstr() {
 
 void VM::op_printstr() {
     size_t reg = fetch_reg();
-    uint32_t index = static_cast<uint32_t>(regs[reg]);
-    if (!prog.strings.valid(index)) {
-        hard_fault(FaultType::OutOfBounds,
-                   std::format("PRINTSTR invalid string index {} at pc={}", index, pc));
-    }
-    std::print("{}", prog.strings.get(index));
+    std::print("{}", string_at(regs[reg], "PRINTSTR"));
 }
 
 void VM::op_eprintstr() {
     size_t reg = fetch_reg();
-    uint32_t index = static_cast<uint32_t>(regs[reg]);
-    if (!prog.strings.valid(index)) {
-        hard_fault(FaultType::OutOfBounds,
-                   std::format("EPRINTSTR invalid string index {} at pc={}", index, pc));
-    }
-    std::print(stderr, "{}", prog.strings.get(index));
+    std::print(stderr, "{}", string_at(regs[reg], "EPRINTSTR"));
 }
 
 void VM::op_write() {
@@ -90,41 +92,47 @@ void VM::op_write() {
     }
     pc += len;
 }
-// TODO: make better
 void VM::op_read() {
+    if (yield_if_blocked_on_stdin()) {
+        return;
+    }
+    terminal::LineMode line_mode;
     size_t reg = fetch_reg();
-    long long v = 0;
-    if (std::scanf("%lld", &v) != 1) {
+    int64_t v = 0;
+    if (!stdin_buf.read_int(v)) {
         v = 0;
     }
-
-    int c;
-    while ((c = std::getchar()) != EOF && c != '\n') {
-    }
-    regs[reg] = static_cast<int64_t>(v);
+    stdin_buf.skip_line();
+    regs[reg] = v;
 }
 
 void VM::op_readstr() {
+    if (yield_if_blocked_on_stdin()) {
+        return;
+    }
+    terminal::LineMode line_mode;
     size_t reg = fetch_reg();
     std::string line;
-    std::getline(std::cin, line);
-    uint32_t handle = prog.strings.intern(line);
-    regs[reg] = static_cast<int64_t>(handle);
+    stdin_buf.read_line(line);
+    regs[reg] = intern_string(line);
 }
 
 void VM::op_readchar() {
+    if (yield_if_blocked_on_stdin()) {
+        return;
+    }
+    terminal::LineMode line_mode;
     size_t reg = fetch_reg();
     int c;
-    while ((c = std::getchar()) != EOF && (c == ' ' || c == '\t' || c == '\n' || c == '\r')) {
+    while ((c = stdin_buf.get()) != InputBuffer::END &&
+           (c == ' ' || c == '\t' || c == '\n' || c == '\r')) {
     }
-    if (c == EOF) {
+    if (c == InputBuffer::END) {
         regs[reg] = 0;
         return;
     }
-    regs[reg] = static_cast<int64_t>(static_cast<unsigned char>(c));
-    int ch;
-    while ((ch = std::getchar()) != EOF && ch != '\n') {
-    }
+    regs[reg] = static_cast<int64_t>(c);
+    stdin_buf.skip_line();
 }
 
 void VM::op_fopen() {
@@ -146,9 +154,11 @@ void VM::op_fopen() {
                       static_cast<size_t>(fname_len));
     pc += static_cast<size_t>(fname_len);
 
+    bool nonblocking = mode_byte & FD_NONBLOCK;
+    mode_byte &= ~FD_NONBLOCK;
+
     // close existing
-    fds[fd].kind = FD::Kind::Closed;
-    fds[fd].file.reset();
+    close_fd(fd);
 
     if (fname == "/dev/stdout") {
         fds[fd].kind = FD::Kind::StdOut;
@@ -179,6 +189,26 @@ void VM::op_fopen() {
                        std::format("FOPEN invalid mode {} at pc={}", mode_byte, pc));
     }
 
+#ifndef _WIN32
+    std::error_code ec;
+    if (std::filesystem::is_fifo(fname, ec)) {
+        int flags = (mode_byte == 0 ? O_RDONLY : O_WRONLY) | O_CLOEXEC;
+        if (nonblocking) {
+            flags |= O_NONBLOCK;
+        }
+        int os_fd;
+        do {
+            os_fd = ::open(fname.c_str(), flags);
+        } while (os_fd < 0 && errno == EINTR);
+        if (os_fd < 0) {
+            hard_fault(FaultType::OutOfBounds,
+                       std::format("FOPEN failed to open '{}' at pc={}", fname, pc));
+        }
+        attach_os_fd(fd, FD::Kind::Fifo, os_fd, mode_byte == 0);
+        return;
+    }
+#endif
+
     auto file = std::make_unique<std::fstream>(fname, mode);
     if (!file->is_open()) {
         hard_fault(FaultType::OutOfBounds,
@@ -186,6 +216,8 @@ void VM::op_fopen() {
     }
     fds[fd].kind = FD::Kind::File;
     fds[fd].file = std::move(file);
+    fds[fd].path = std::move(fname);
+    fds[fd].mode = mode_byte;
 }
 
 void VM::op_fclose() {
@@ -194,39 +226,314 @@ void VM::op_fclose() {
     if (fd >= FILE_DESCRIPTORS) {
         hard_fault(FaultType::OutOfBounds, std::format("FCLOSE invalid fd {} at pc={}", fd, pc));
     }
-    fds[fd].kind = FD::Kind::Closed;
-    fds[fd].file.reset();
+    close_fd(fd);
 }
 
 void VM::op_fread() {
-    uint8_t fd = fetch_u8();
+    FD& f = fetch_fd("FREAD");
     size_t reg = fetch_reg();
 
-    if (fd >= FILE_DESCRIPTORS) {
-        hard_fault(FaultType::OutOfBounds, std::format("FREAD invalid fd {} at pc={}", fd, pc));
+    if (f.kind == FD::Kind::StdIn && yield_if_blocked_on_stdin()) {
+        return;
     }
-    std::istream* in = fds[fd].reader();
-    if (!in) {
-        hard_fault(FaultType::OutOfBounds,
-                   std::format("FREAD fd {} not open for reading at pc={}", fd, pc));
+    // let other coroutines run while a pipe has nothing to read
+    if (f.in && !f.in->buffered() && live_coroutines > 1 &&
+        !Reactor::wait_one(f.os_fd, Reactor::READABLE, 0) && yield_to_retry()) {
+        return;
     }
-    int c = in->get();
-    regs[reg] = (c == EOF) ? -1 : static_cast<int64_t>(c);
+    regs[reg] = read_byte(f, false, "FREAD");
 }
 
 void VM::op_fwrite() {
-    uint8_t fd = fetch_u8();
+    FD& f = fetch_fd("FWRITE");
     int64_t val = read_operand();
-    if (fd >= FILE_DESCRIPTORS) {
-        hard_fault(FaultType::OutOfBounds, std::format("FWRITE invalid fd {} at pc={}", fd, pc));
+    write_byte(f, static_cast<uint8_t>(val), false, "FWRITE");
+}
+
+// an OS descriptor positioned where the fd's next read or write would go. Files get a fresh
+// descriptor because the fstream does not expose its own
+int VM::open_for_copy(FD& f, bool write) {
+    switch (f.kind) {
+        case FD::Kind::StdIn:
+            return write ? -1 : 0;
+        case FD::Kind::StdOut:
+            std::cout.flush();
+            std::fflush(stdout);
+            return write ? 1 : -1;
+        case FD::Kind::StdErr:
+            std::cerr.flush();
+            std::fflush(stderr);
+            return write ? 2 : -1;
+        case FD::Kind::Pipe:
+        case FD::Kind::Fifo:
+            return write == !f.in ? f.os_fd : -1;
+        case FD::Kind::File:
+            break;
+        default:
+            return -1;
+    }
+    if (write == (f.mode == 0)) {
+        return -1;
+    }
+    f.file->clear();
+    if (write) {
+        f.file->flush();
+    }
+    auto pos = static_cast<int64_t>(write ? f.file->tellp() : f.file->tellg());
+#ifdef _WIN32
+    int os_fd = _open(f.path.c_str(), (write ? _O_WRONLY : _O_RDONLY) | _O_BINARY);
+    if (os_fd >= 0) {
+        _lseeki64(os_fd, f.mode == 2 ? 0 : pos, f.mode == 2 ? SEEK_END : SEEK_SET);
+    }
+#else
+    int os_fd = ::open(f.path.c_str(), (write ? O_WRONLY : O_RDONLY) | O_CLOEXEC);
+    if (os_fd >= 0) {
+        lseek(os_fd, f.mode == 2 ? 0 : static_cast<off_t>(pos), f.mode == 2 ? SEEK_END : SEEK_SET);
+    }
+#endif
+    return os_fd;
+}
+
+// moves a File's stream to where the copy left its descriptor, then closes the descriptor
+void VM::finish_copy(FD& f, int os_fd, bool write) {
+    if (f.kind != FD::Kind::File) {
+        return;
+    }
+#ifdef _WIN32
+    auto pos = static_cast<std::streamoff>(_lseeki64(os_fd, 0, SEEK_CUR));
+    _close(os_fd);
+#else
+    auto pos = static_cast<std::streamoff>(lseek(os_fd, 0, SEEK_CUR));
+    ::close(os_fd);
+#endif
+    f.file->clear();
+    if (write) {
+        f.file->seekp(pos, std::ios::beg);
+    } else {
+        f.file->seekg(pos, std::ios::beg);
+    }
+}
+
+// copies up to count bytes (all of them when negative) and stores how many were copied
+void VM::op_fcopy() {
+    FD& src = fetch_fd("FCOPY");
+    FD& dst = fetch_fd("FCOPY");
+    size_t reg = fetch_reg();
+    uint64_t max = regs[reg] < 0 ? UINT64_MAX : static_cast<uint64_t>(regs[reg]);
+
+    int in_fd = open_for_copy(src, false);
+    if (in_fd < 0) {
+        hard_fault(FaultType::OutOfBounds, std::format("FCOPY fd {} not open for reading at pc={}",
+                                                       &src - fds.data(), pc));
     }
-    std::ostream* out = fds[fd].writer();
-    if (!out) {
+    int out_fd = open_for_copy(dst, true);
+    if (out_fd < 0) {
+        finish_copy(src, in_fd, false);
+        hard_fault(FaultType::OutOfBounds, std::format("FCOPY fd {} not open for writing at pc={}",
+                                                       &dst - fds.data(), pc));
+    }
+
+    // bytes the VM already pulled out of a pipe or stdin come first
+    uint64_t copied = 0;
+    bool ok = true;
+    if (InputBuffer* buffered = src.kind == FD::Kind::StdIn ? &stdin_buf : src.in.get()) {
+        std::string pending;
+        copied = buffered->take(pending, static_cast<size_t>(std::min<uint64_t>(max, SIZE_MAX)));
+        ok = file_copy::write_all(out_fd, pending);
+    }
+    if (ok && copied < max) {
+        int64_t n = file_copy::copy(in_fd, out_fd, max - copied);
+        ok = n >= 0;
+        copied += ok ? static_cast<uint64_t>(n) : 0;
+    }
+
+    finish_copy(src, in_fd, false);
+    finish_copy(dst, out_fd, true);
+    if (!ok) {
+        hard_fault(FaultType::OutOfBounds, std::format("FCOPY failed at pc={}", pc));
+    }
+    regs[reg] = static_cast<int64_t>(copied);
+}
+
+// maps a file into a new read-only heap window; base gets the first slot, len the byte count
+void VM::op_fmap() {
+    require_privileged("FMAP");
+
+    FD& f = fetch_fd("FMAP");
+    size_t base_reg = fetch_reg();
+    size_t len_reg = fetch_reg();
+
+    int os_fd = open_for_copy(f, false);
+    if (os_fd < 0) {
+        hard_fault(FaultType::OutOfBounds,
+                   std::format("FMAP fd {} not open for reading at pc={}", &f - fds.data(), pc));
+    }
+#ifdef _WIN32
+    int64_t pos = _lseeki64(os_fd, 0, SEEK_CUR);
+    int64_t size = _lseeki64(os_fd, 0, SEEK_END);
+    _lseeki64(os_fd, pos, SEEK_SET);
+#else
+    int64_t pos = lseek(os_fd, 0, SEEK_CUR);
+    int64_t size = lseek(os_fd, 0, SEEK_END);
+    lseek(os_fd, pos, SEEK_SET);
+#endif
+    if (size < 0) {
+        finish_copy(f, os_fd, false);
+        hard_fault(FaultType::OutOfBounds,
+                   std::format("FMAP fd {} is not a regular file at pc={}", &f - fds.data(), pc));
+    }
+    uint64_t bytes = static_cast<uint64_t>(size);
+    if (regs[len_reg] >= 0) {
+        bytes = std::min(bytes, static_cast<uint64_t>(regs[len_reg]));
+    }
+    uint64_t slots = (bytes + sizeof(int64_t) - 1) / sizeof(int64_t);
+    if (slots > UINT32_MAX) {
+        finish_copy(f, os_fd, false);
+        hard_fault(FaultType::OutOfBounds, std::format("FMAP file too large at pc={}", pc));
+    }
+    // the window starts on a page boundary, so the padding before it counts too
+    check_heap_quota(op_stack.map_end(bytes), "FMAP");
+
+    size_t old_size = op_stack.size();
+    auto base = op_stack.map_file(os_fd, bytes);
+    finish_copy(f, os_fd, false);
+    if (!base) {
+        hard_fault(FaultType::OutOfBounds, std::format("FMAP failed to map fd {} at pc={}",
+                                                       &f - fds.data(), pc));
+    }
+
+    op_stack_perms.resize(op_stack.size());
+    std::fill(op_stack_perms.begin() + old_size, op_stack_perms.begin() + *base,
+              SlotPermission{1, 1, 1, 1});
+    std::fill(op_stack_perms.begin() + *base, op_stack_perms.end(), SlotPermission{1, 0, 1, 0});
+    note_restricted(*base, op_stack_perms.size());
+    regs[base_reg] = static_cast<int64_t>(*base);
+    regs[len_reg] = static_cast<int64_t>(bytes);
+}
+
+void VM::op_funmap() {
+    require_privileged("FUNMAP");
+
+    int64_t base = regs[fetch_reg()];
+    auto slots = base < 0 ? std::nullopt : op_stack.unmap(static_cast<size_t>(base));
+    if (!slots) {
+        hard_fault(FaultType::OutOfBounds,
+                   std::format("FUNMAP {} is not a mapped window at pc={}", base, pc));
+    }
+    // slots still below the top stay as ordinary writable memory
+    size_t end = std::min(op_stack.size(), static_cast<size_t>(base) + *slots);
+    for (size_t i = static_cast<size_t>(base); i < end; i++) {
+        op_stack_perms[i] = SlotPermission{1, 1, 1, 1};
+    }
+    op_stack_perms.resize(op_stack.size());
+    heap_alloc.truncate(op_stack.size());
+}
+
+void VM::op_freadnb() {
+    FD& f = fetch_fd("FREADNB");
+    size_t reg = fetch_reg();
+
+    int c = read_byte(f, true, "FREADNB");
+    ZF = c == WOULD_BLOCK;
+    regs[reg] = c == WOULD_BLOCK ? -1 : c;
+}
+
+void VM::op_fwritenb() {
+    FD& f = fetch_fd("FWRITENB");
+    int64_t val = read_operand();
+    ZF = !write_byte(f, static_cast<uint8_t>(val), true, "FWRITENB");
+}
+
+void VM::op_pipe() {
+    require_privileged("PIPE");
+
+    uint8_t flags = fetch_u8();
+    uint8_t rfd = fetch_u8();
+    uint8_t wfd = fetch_u8();
+    if (rfd >= FILE_DESCRIPTORS || wfd >= FILE_DESCRIPTORS || rfd == wfd) {
         hard_fault(FaultType::OutOfBounds,
-                   std::format("FWRITE fd {} not open for writing at pc={}", fd, pc));
+                   std::format("PIPE invalid fds {}, {} at pc={}", rfd, wfd, pc));
+    }
+
+    int ends[2];
+#ifdef _WIN32
+    bool ok = _pipe(ends, 64 * 1024, _O_BINARY) == 0;
+#else
+    bool ok = pipe(ends) == 0;
+    if (ok) {
+        for (int end : ends) {
+            fcntl(end, F_SETFD, FD_CLOEXEC);
+            if (flags & FD_NONBLOCK) {
+                fcntl(end, F_SETFL, fcntl(end, F_GETFL) | O_NONBLOCK);
+            }
+        }
+    }
+#endif
+    if (!ok) {
+        hard_fault(FaultType::OutOfBounds, std::format("PIPE failed at pc={}", pc));
+    }
+    attach_os_fd(rfd, FD::Kind::Pipe, ends[0], true);
+    attach_os_fd(wfd, FD::Kind::Pipe, ends[1], false);
+}
+
+// waits until any fd listed in the heap range is ready; bit i of dst is set when slot i is
+void VM::op_poll() {
+    size_t dst = fetch_reg();
+    size_t base = fetch_heap_base("POLL");
+    int64_t count = read_operand();
+    int64_t timeout = read_operand();
+    if (count < 0 || count > static_cast<int64_t>(MAX_POLL_FDS)) {
+        hard_fault(FaultType::OutOfBounds, std::format("POLL invalid count {} at pc={}", count, pc));
+    }
+    check_heap_range(base, static_cast<size_t>(count), false, "POLL");
+
+    std::array<uint32_t, MAX_POLL_FDS + 1> want;
+    size_t n_want = 0;
+    uint64_t mask = 0;
+    for (size_t i = 0; i < static_cast<size_t>(count); i++) {
+        int64_t fd = op_stack[base + i];
+        if (fd < 0 || fd >= static_cast<int64_t>(FILE_DESCRIPTORS) ||
+            fds[fd].kind == FD::Kind::Closed) {
+            hard_fault(FaultType::OutOfBounds,
+                       std::format("POLL fd {} is not open at pc={}", fd, pc));
+        }
+        const FD& f = fds[fd];
+        switch (f.kind) {
+            case FD::Kind::StdIn:
+                if (stdin_buf.buffered()) {
+                    mask |= uint64_t{1} << i;
+                } else {
+                    want[n_want++] = STDIN_TAG;
+                }
+                break;
+            case FD::Kind::Pipe:
+            case FD::Kind::Fifo:
+                if (f.in && f.in->buffered()) {
+                    mask |= uint64_t{1} << i;
+                } else {
+                    want[n_want++] = static_cast<uint32_t>(fd);
+                }
+                break;
+            default:
+                // regular files and the standard output streams never block
+                mask |= uint64_t{1} << i;
+                break;
+        }
+    }
+
+    std::array<uint32_t, MAX_POLL_FDS + 1> ready;
+    int timeout_ms = mask ? 0 : static_cast<int>(std::clamp<int64_t>(timeout, -1, INT32_MAX));
+    size_t n_ready = reactor.wait(std::span(want.data(), n_want), timeout_ms, ready);
+    for (size_t r = 0; r < n_ready; r++) {
+        for (size_t i = 0; i < static_cast<size_t>(count); i++) {
+            int64_t fd = op_stack[base + i];
+            uint32_t tag = fds[fd].kind == FD::Kind::StdIn ? STDIN_TAG : static_cast<uint32_t>(fd);
+            if (tag == ready[r]) {
+                mask |= uint64_t{1} << i;
+            }
+        }
     }
-    out->put(static_cast<char>(val));
-    out->flush();
+    regs[dst] = static_cast<int64_t>(mask);
 }
 
 void VM::op_fseek() {
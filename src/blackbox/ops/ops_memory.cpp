@@ -3,7 +3,10 @@
 //
 
 #include "ops_memory.hpp"
+#include "../simd.hpp"
 #include "../vm.hpp"
+#include <algorithm>
+#include <cstring>
 #include <format>
 
 void VM::op_loadref() {
@@ -48,6 +51,7 @@ void VM::op_alloc() {
     require_privileged("ALLOC");
     uint32_t elems = fetch_u32();
     if (elems > op_stack.size()) {
+        check_heap_quota(elems, "ALLOC");
         op_stack.resize(elems, 0);
         op_stack_perms.resize(elems, SlotPermission{1, 1, 1, 1});
     }
@@ -60,6 +64,7 @@ void VM::op_grow() {
         return;
     }
     size_t new_size = op_stack.size() + elems;
+    check_heap_quota(new_size, "GROW");
     op_stack.resize(new_size, 0);
     op_stack_perms.resize(new_size, SlotPermission{1, 1, 1, 1});
 }
@@ -67,8 +72,10 @@ void VM::op_grow() {
 void VM::op_resize() {
     require_privileged("RESIZE");
     uint32_t new_size = fetch_u32();
+    check_heap_quota(new_size, "RESIZE");
     op_stack.resize(new_size, 0);
     op_stack_perms.resize(new_size, SlotPermission{1, 1, 1, 1});
+    heap_alloc.truncate(new_size);
 }
 
 void VM::op_free() {
@@ -81,9 +88,236 @@ void VM::op_free() {
     size_t new_size = op_stack.size() - elems;
     op_stack.resize(new_size);
     op_stack_perms.resize(new_size);
+    heap_alloc.truncate(new_size);
+}
+
+// HALLOC and HFREE hand out and take back blocks from heap_alloc, growing the heap a region at a
+// time when its free lists run dry. a POP, FREE, RESIZE or FUNMAP below the allocator's blocks
+// discards them; every op that shrinks the heap trims heap_alloc to match straight away, so a
+// later GROW over the same slots cannot hand them back as blocks
+void VM::op_halloc() {
+    require_privileged("HALLOC");
+    size_t dst = fetch_reg();
+    int64_t count = read_operand();
+    if (count <= 0) {
+        hard_fault(FaultType::OutOfBounds,
+                   std::format("HALLOC size {} must be positive at pc={}", count, pc));
+    }
+    auto n = static_cast<size_t>(count);
+    if (n > op_stack.capacity()) {
+        hard_fault(FaultType::OutOfBounds,
+                   std::format("HALLOC size {} exceeds the heap capacity at pc={}", n, pc));
+    }
+    auto base = heap_alloc.allocate(n);
+    if (!base) {
+        size_t old_size = op_stack.size();
+        size_t grow = heap_alloc.region_size(n);
+        if (grow > op_stack.capacity() - old_size) {
+            hard_fault(FaultType::OutOfBounds,
+                       std::format("HALLOC size {} exceeds the heap capacity at pc={}", n, pc));
+        }
+        check_heap_quota(old_size + grow, "HALLOC");
+        op_stack.resize(old_size + grow, 0);
+        op_stack_perms.resize(op_stack.size(), SlotPermission{1, 1, 1, 1});
+        heap_alloc.add_region(old_size, grow);
+        base = heap_alloc.allocate(n);
+    }
+    // reused blocks still hold what the last owner left in them
+    std::fill_n(op_stack.data() + *base, n, 0);
+    regs[dst] = static_cast<int64_t>(*base);
+}
+
+void VM::op_hfree() {
+    require_privileged("HFREE");
+    int64_t base = read_operand();
+    if (base < 0 || !heap_alloc.release(static_cast<size_t>(base))) {
+        hard_fault(FaultType::OutOfBounds,
+                   std::format("HFREE {} is not an allocated block at pc={}", base, pc));
+    }
+}
+
+// packed view of the heap: the slots starting at base as an array of width-byte elements, laid
+// out as in memory, so an FMAP window reads in file order and a byte array takes an eighth of
+// the slots. widths divide 8, so an element never straddles two slots and one permission check
+// covers it
+uint8_t* VM::packed_element(size_t base, int64_t index, size_t width, bool write,
+                            std::string_view opname) {
+    if (index < 0) {
+        hard_fault(FaultType::OutOfBounds, std::format("{} negative index at pc={}", opname, pc));
+    }
+    if (static_cast<uint64_t>(index) > op_stack.size() * sizeof(int64_t)) {
+        hard_fault(FaultType::OutOfBounds,
+                   std::format("{} index {} out of bounds at pc={}", opname, index, pc));
+    }
+    size_t offset = static_cast<size_t>(index) * width;
+    check_heap_range(base + offset / sizeof(int64_t), 1, write, opname);
+    return reinterpret_cast<uint8_t*>(op_stack.data() + base) + offset;
+}
+
+void VM::packed_load(size_t width, bool sign, std::string_view opname) {
+    size_t dst = fetch_reg();
+    size_t base = fetch_heap_base(opname);
+    int64_t index = read_operand();
+    const uint8_t* p = packed_element(base, index, width, false, opname);
+    switch (width) {
+        case 1:
+            regs[dst] = sign ? int64_t{static_cast<int8_t>(*p)} : int64_t{*p};
+            break;
+        case 2: {
+            uint16_t v;
+            std::memcpy(&v, p, sizeof(v));
+            regs[dst] = sign ? int64_t{static_cast<int16_t>(v)} : int64_t{v};
+            break;
+        }
+        default: {
+            uint32_t v;
+            std::memcpy(&v, p, sizeof(v));
+            regs[dst] = sign ? int64_t{static_cast<int32_t>(v)} : int64_t{v};
+            break;
+        }
+    }
+}
+
+// stores the low width bytes of the value
+void VM::packed_store(size_t width, std::string_view opname) {
+    size_t base = fetch_heap_base(opname);
+    int64_t index = read_operand();
+    auto value = static_cast<uint64_t>(read_operand());
+    uint8_t* p = packed_element(base, index, width, true, opname);
+    switch (width) {
+        case 1:
+            *p = static_cast<uint8_t>(value);
+            break;
+        case 2: {
+            auto v = static_cast<uint16_t>(value);
+            std::memcpy(p, &v, sizeof(v));
+            break;
+        }
+        default: {
+            auto v = static_cast<uint32_t>(value);
+            std::memcpy(p, &v, sizeof(v));
+            break;
+        }
+    }
+}
+
+void VM::op_loadb() {
+    packed_load(1, false, "LOADB");
+}
+
+void VM::op_loadw() {
+    packed_load(2, false, "LOADW");
+}
+
+void VM::op_loadd() {
+    packed_load(4, false, "LOADD");
+}
+
+void VM::op_loadsb() {
+    packed_load(1, true, "LOADSB");
+}
+
+void VM::op_loadsw() {
+    packed_load(2, true, "LOADSW");
+}
+
+void VM::op_loadsd() {
+    packed_load(4, true, "LOADSD");
+}
+
+void VM::op_storeb() {
+    packed_store(1, "STOREB");
+}
+
+void VM::op_storew() {
+    packed_store(2, "STOREW");
+}
+
+void VM::op_stored() {
+    packed_store(4, "STORED");
+}
+
+// index of the first slot in [heap, heap + count) equal to value, or -1
+void VM::op_heapfind() {
+    size_t dst = fetch_reg();
+    size_t base = fetch_heap_base("HEAPFIND");
+    int64_t count = read_operand();
+    int64_t value = read_operand();
+    if (count < 0) {
+        hard_fault(FaultType::OutOfBounds, std::format("HEAPFIND negative count at pc={}", pc));
+    }
+    auto n = static_cast<size_t>(count);
+    check_heap_range(base, n, false, "HEAPFIND");
+    size_t at = simd::find_i64(op_stack.data() + base, n, value);
+    regs[dst] = at == n ? -1 : static_cast<int64_t>(at);
+}
+
+// bulk slot operations check each range once and then run as a single memmove, fill or
+// compare, so clearing or copying a large array is one instruction instead of a MOV loop
+
+void VM::op_memcpy() {
+    size_t dst = fetch_heap_base("MEMCPY");
+    size_t src = fetch_heap_base("MEMCPY");
+    int64_t count = read_operand();
+    if (count < 0) {
+        hard_fault(FaultType::OutOfBounds, std::format("MEMCPY negative count at pc={}", pc));
+    }
+    auto n = static_cast<size_t>(count);
+    check_heap_range(src, n, false, "MEMCPY");
+    check_heap_range(dst, n, true, "MEMCPY");
+    if (n != 0 && dst < src + n && src < dst + n && dst != src) {
+        hard_fault(FaultType::IllegalOp,
+                   std::format("MEMCPY ranges overlap (use MEMMOVE) at pc={}", pc));
+    }
+    std::copy_n(op_stack.data() + src, n, op_stack.data() + dst);
+}
+
+void VM::op_memmove() {
+    size_t dst = fetch_heap_base("MEMMOVE");
+    size_t src = fetch_heap_base("MEMMOVE");
+    int64_t count = read_operand();
+    if (count < 0) {
+        hard_fault(FaultType::OutOfBounds, std::format("MEMMOVE negative count at pc={}", pc));
+    }
+    auto n = static_cast<size_t>(count);
+    check_heap_range(src, n, false, "MEMMOVE");
+    check_heap_range(dst, n, true, "MEMMOVE");
+    if (n != 0) {
+        std::memmove(op_stack.data() + dst, op_stack.data() + src, n * sizeof(int64_t));
+    }
+}
+
+void VM::op_memset() {
+    size_t base = fetch_heap_base("MEMSET");
+    int64_t count = read_operand();
+    int64_t value = read_operand();
+    if (count < 0) {
+        hard_fault(FaultType::OutOfBounds, std::format("MEMSET negative count at pc={}", pc));
+    }
+    auto n = static_cast<size_t>(count);
+    check_heap_range(base, n, true, "MEMSET");
+    std::fill_n(op_stack.data() + base, n, value);
+}
+
+// -1, 0 or 1 as for STRCMP, comparing the first differing slots as signed values
+void VM::op_memcmp() {
+    size_t dst = fetch_reg();
+    size_t a = fetch_heap_base("MEMCMP");
+    size_t b = fetch_heap_base("MEMCMP");
+    int64_t count = read_operand();
+    if (count < 0) {
+        hard_fault(FaultType::OutOfBounds, std::format("MEMCMP negative count at pc={}", pc));
+    }
+    auto n = static_cast<size_t>(count);
+    check_heap_range(a, n, false, "MEMCMP");
+    check_heap_range(b, n, false, "MEMCMP");
+    const int64_t* left = op_stack.data() + a;
+    const int64_t* right = op_stack.data() + b;
+    auto [l, r] = std::mismatch(left, left + n, right);
+    regs[dst] = l == left + n ? 0 : (*l < *r ? -1 : 1);
 }
 
 void VM::op_mov() {
     auto& dst = fetch_writable();
     dst = read_operand();
-}
\ No newline at end of file
+}
@@ -4,6 +4,8 @@
 
 #include "ops_priv.hpp"
 #include "../vm.hpp"
+#include <algorithm>
+#include <cstdint>
 #include <format>
 #include <print>
 
@@ -93,6 +95,22 @@ void VM::op_getfault() {
     regs[reg] = static_cast<int64_t>(current_fault);
 }
 
+void VM::op_refuel() {
+    require_privileged("REFUEL");
+    int64_t units = read_operand();
+    if (units < 0) {
+        hard_fault(FaultType::OutOfBounds,
+                   std::format("REFUEL negative amount {} at pc={}", units, pc));
+    }
+    uint64_t add = static_cast<uint64_t>(units);
+    fuel = add > UINT64_MAX - fuel ? UINT64_MAX : fuel + add;
+}
+
+void VM::op_getfuel() {
+    size_t reg = fetch_reg();
+    regs[reg] = fuel_metered ? static_cast<int64_t>(std::min<uint64_t>(fuel, INT64_MAX)) : -1;
+}
+
 void VM::op_setperm() {
     require_privileged("SETPERM");
 
@@ -103,6 +121,9 @@ void VM::op_setperm() {
     uint8_t prot_r = fetch_u8();
     uint8_t prot_w = fetch_u8();
 
+    if (!(priv_r && priv_w && prot_r && prot_w)) {
+        note_restricted(start, std::min(static_cast<size_t>(start) + count, op_stack_perms.size()));
+    }
     for (uint32_t i = 0; i < count; i++) {
         size_t idx = static_cast<size_t>(start) + i;
         if (idx >= op_stack_perms.size()) {
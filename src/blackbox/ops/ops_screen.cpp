@@ -0,0 +1,51 @@
+//
+// Created by User on 2026-04-18.
+//
+
+#include "ops_screen.hpp"
+#include "../vm.hpp"
+#include <cstdio>
+#include <format>
+
+void VM::op_scrinit() {
+    int64_t width = read_operand();
+    int64_t height = read_operand();
+    if (width <= 0 || height <= 0 || static_cast<uint64_t>(width) > MAX_SCREEN_SIZE ||
+        static_cast<uint64_t>(height) > MAX_SCREEN_SIZE) {
+        hard_fault(FaultType::OutOfBounds,
+                   std::format("SCRINIT invalid size {}x{} at pc={}", width, height, pc));
+    }
+    screen.init(static_cast<size_t>(width), static_cast<size_t>(height));
+}
+
+void VM::op_scrput() {
+    int64_t x = read_operand();
+    int64_t y = read_operand();
+    int64_t ch = read_operand();
+    if (!screen.ready()) {
+        hard_fault(FaultType::IllegalOp, std::format("SCRPUT before SCRINIT at pc={}", pc));
+    }
+    if (x < 0 || y < 0 || static_cast<size_t>(x) >= screen.width() ||
+        static_cast<size_t>(y) >= screen.height()) {
+        hard_fault(FaultType::OutOfBounds,
+                   std::format("SCRPUT cell ({}, {}) out of bounds at pc={}", x, y, pc));
+    }
+    screen.put(static_cast<size_t>(x), static_cast<size_t>(y), ch);
+}
+
+void VM::op_scrblit() {
+    size_t base = fetch_heap_base("SCRBLIT");
+    if (!screen.ready()) {
+        hard_fault(FaultType::IllegalOp, std::format("SCRBLIT before SCRINIT at pc={}", pc));
+    }
+    size_t count = screen.width() * screen.height();
+    check_heap_range(base, count, false, "SCRBLIT");
+    screen.blit(std::span<const int64_t>(op_stack.data() + base, count));
+}
+
+void VM::op_scrflush() {
+    if (!screen.ready()) {
+        hard_fault(FaultType::IllegalOp, std::format("SCRFLUSH before SCRINIT at pc={}", pc));
+    }
+    screen.flush(stdout);
+}
@@ -0,0 +1,289 @@
+//
+// Created by User on 2026-04-18.
+//
+
+#include "ops_string.hpp"
+#include "../simd.hpp"
+#include "../vm.hpp"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <format>
+#include <string>
+#include <vector>
+
+// every result goes through intern_string, so equal text still shares one handle and the
+// string quota and collector see it
+
+void VM::op_strcat() {
+    size_t dst = fetch_reg();
+    int64_t a = regs[fetch_reg()];
+    int64_t b = regs[fetch_reg()];
+    std::string_view left = string_at(a, "STRCAT");
+    std::string_view right = string_at(b, "STRCAT");
+    if (right.empty()) {
+        regs[dst] = a;
+        return;
+    }
+    if (left.empty()) {
+        regs[dst] = b;
+        return;
+    }
+    std::string joined;
+    joined.reserve(left.size() + right.size());
+    joined.append(left).append(right);
+    regs[dst] = intern_string(joined);
+}
+
+void VM::op_strlen() {
+    size_t dst = fetch_reg();
+    size_t src = fetch_reg();
+    regs[dst] = static_cast<int64_t>(string_at(regs[src], "STRLEN").size());
+}
+
+// start and length are clamped to the string, a negative length means the rest of it
+void VM::op_substr() {
+    size_t dst = fetch_reg();
+    int64_t handle = regs[fetch_reg()];
+    int64_t start = read_operand();
+    int64_t len = read_operand();
+    std::string_view text = string_at(handle, "SUBSTR");
+
+    auto size = static_cast<int64_t>(text.size());
+    start = std::clamp<int64_t>(start, 0, size);
+    if (len < 0 || len > size - start) {
+        len = size - start;
+    }
+    if (start == 0 && len == size) {
+        regs[dst] = handle;
+        return;
+    }
+    regs[dst] = intern_string(text.substr(static_cast<size_t>(start), static_cast<size_t>(len)));
+}
+
+// -1, 0 or 1 by byte-wise comparison
+void VM::op_strcmp() {
+    size_t dst = fetch_reg();
+    int64_t a = regs[fetch_reg()];
+    int64_t b = regs[fetch_reg()];
+    if (a == b) {
+        regs[dst] = 0;
+        return;
+    }
+    int c = string_at(a, "STRCMP").compare(string_at(b, "STRCMP"));
+    regs[dst] = (c > 0) - (c < 0);
+}
+
+// the byte at index, or -1 past either end
+void VM::op_charat() {
+    size_t dst = fetch_reg();
+    int64_t handle = regs[fetch_reg()];
+    int64_t index = read_operand();
+    std::string_view text = string_at(handle, "CHARAT");
+    if (index < 0 || static_cast<uint64_t>(index) >= text.size()) {
+        regs[dst] = -1;
+        return;
+    }
+    regs[dst] = static_cast<uint8_t>(text[static_cast<size_t>(index)]);
+}
+
+// heap bytes are packed 8 per slot, little-endian, the same view LOADB and FMAP use
+void VM::op_strfromheap() {
+    size_t dst = fetch_reg();
+    size_t base = fetch_heap_base("STRFROMHEAP");
+    int64_t len = read_operand();
+    if (len < 0) {
+        hard_fault(FaultType::OutOfBounds,
+                   std::format("STRFROMHEAP negative length at pc={}", pc));
+    }
+    auto bytes = static_cast<size_t>(len);
+    check_heap_range(base, (bytes + sizeof(int64_t) - 1) / sizeof(int64_t), false, "STRFROMHEAP");
+    regs[dst] = intern_string(
+        std::string_view(reinterpret_cast<const char*>(op_stack.data() + base), bytes));
+}
+
+// searches start at a byte offset so a loop can walk every match; the result is an absolute
+// offset, or -1
+void VM::op_strfind() {
+    size_t dst = fetch_reg();
+    int64_t hay = regs[fetch_reg()];
+    int64_t needle = regs[fetch_reg()];
+    int64_t start = std::max<int64_t>(read_operand(), 0);
+    std::string_view text = string_at(hay, "STRFIND");
+    std::string_view want = string_at(needle, "STRFIND");
+    if (static_cast<uint64_t>(start) > text.size()) {
+        regs[dst] = -1;
+        return;
+    }
+    size_t at = simd::find(text.substr(static_cast<size_t>(start)), want);
+    regs[dst] = at == std::string_view::npos ? -1 : start + static_cast<int64_t>(at);
+}
+
+void VM::op_strchr() {
+    size_t dst = fetch_reg();
+    int64_t handle = regs[fetch_reg()];
+    int64_t ch = read_operand();
+    int64_t start = std::max<int64_t>(read_operand(), 0);
+    std::string_view text = string_at(handle, "STRCHR");
+    if (static_cast<uint64_t>(start) >= text.size()) {
+        regs[dst] = -1;
+        return;
+    }
+    auto from = static_cast<size_t>(start);
+    size_t at = simd::find_byte(text.data() + from, text.size() - from, static_cast<char>(ch));
+    regs[dst] = at == text.size() - from ? -1 : start + static_cast<int64_t>(at);
+}
+
+// writes one handle per field into consecutive heap slots and stores the field count. with more
+// fields than slots, the last slot gets the unsplit rest
+void VM::op_strsplit() {
+    size_t dst = fetch_reg();
+    int64_t handle = regs[fetch_reg()];
+    int64_t delim_handle = regs[fetch_reg()];
+    size_t base = fetch_heap_base("STRSPLIT");
+    int64_t max = read_operand();
+    if (max <= 0) {
+        regs[dst] = 0;
+        return;
+    }
+
+    std::string delim(string_at(delim_handle, "STRSPLIT"));
+    std::string_view text = string_at(handle, "STRSPLIT");
+    struct Field {
+        size_t offset;
+        size_t length;
+    };
+    std::vector<Field> fields;
+    size_t pos = 0;
+    while (!delim.empty() && fields.size() + 1 < static_cast<uint64_t>(max)) {
+        size_t at = simd::find(text.substr(pos), delim);
+        if (at == std::string_view::npos) {
+            break;
+        }
+        fields.push_back(Field{pos, at});
+        pos += at + delim.size();
+    }
+    fields.push_back(Field{pos, text.size() - pos});
+
+    check_heap_range(base, fields.size(), true, "STRSPLIT");
+    for (size_t i = 0; i < fields.size(); i++) {
+        // interning may collect and move the source string, so look it up again each time; the
+        // pieces already stored in the heap keep themselves alive
+        std::string_view source = string_at(handle, "STRSPLIT");
+        op_stack[base + i] = intern_string(source.substr(fields[i].offset, fields[i].length));
+    }
+    regs[dst] = static_cast<int64_t>(fields.size());
+}
+
+namespace {
+
+// appends v in base (2..36) using std::to_chars, which never allocates
+void append_int(std::string& out, int64_t v, int base) {
+    std::array<char, 66> buf; // 64 binary digits and a sign
+    auto res = std::to_chars(buf.data(), buf.data() + buf.size(), v, base);
+    out.append(buf.data(), res.ptr);
+}
+
+} // namespace
+
+void VM::op_itoa() {
+    size_t dst = fetch_reg();
+    int64_t value = regs[fetch_reg()];
+    int64_t base = read_operand();
+    if (base < 2 || base > 36) {
+        hard_fault(FaultType::IllegalOp,
+                   std::format("ITOA base {} out of range at pc={}", base, pc));
+    }
+    std::string text;
+    append_int(text, value, static_cast<int>(base));
+    regs[dst] = intern_string(text);
+}
+
+// surrounding whitespace and a leading '+' are accepted; anything else that is not part of the
+// number, or a value that does not fit in 64 bits, stores 0 and sets ZF=1
+void VM::op_atoi() {
+    size_t dst = fetch_reg();
+    int64_t handle = regs[fetch_reg()];
+    int64_t base = read_operand();
+    if (base < 2 || base > 36) {
+        hard_fault(FaultType::IllegalOp,
+                   std::format("ATOI base {} out of range at pc={}", base, pc));
+    }
+    std::string_view text = string_at(handle, "ATOI");
+    size_t first = text.find_first_not_of(" \t\r\n");
+    size_t last = text.find_last_not_of(" \t\r\n");
+    text = first == std::string_view::npos ? std::string_view{}
+                                            : text.substr(first, last - first + 1);
+    if (text.size() > 1 && text.front() == '+' && text[1] != '-') {
+        text.remove_prefix(1);
+    }
+
+    int64_t value = 0;
+    auto res =
+        std::from_chars(text.data(), text.data() + text.size(), value, static_cast<int>(base));
+    bool ok = !text.empty() && res.ec == std::errc{} && res.ptr == text.data() + text.size();
+    regs[dst] = ok ? value : 0;
+    ZF = ok ? 0 : 1;
+}
+
+// placeholders take the argument registers in order: {} decimal, {x} hex, {b} binary, {c} the
+// byte with that value, {s} the string the register holds. {{ and }} are literal braces
+void VM::op_strfmt() {
+    size_t dst = fetch_reg();
+    int64_t tmpl_handle = regs[fetch_reg()];
+    uint8_t argc = fetch_u8();
+    std::array<int64_t, 256> args;
+    for (uint8_t i = 0; i < argc; i++) {
+        args[i] = regs[fetch_reg()];
+    }
+
+    std::string_view tmpl = string_at(tmpl_handle, "STRFMT");
+    std::string out;
+    out.reserve(tmpl.size());
+    size_t next = 0;
+    for (size_t i = 0; i < tmpl.size(); i++) {
+        char c = tmpl[i];
+        if (c == '}' && i + 1 < tmpl.size() && tmpl[i + 1] == '}') {
+            out += '}';
+            i++;
+            continue;
+        }
+        if (c != '{') {
+            out += c;
+            continue;
+        }
+        if (i + 1 < tmpl.size() && tmpl[i + 1] == '{') {
+            out += '{';
+            i++;
+            continue;
+        }
+        size_t close = tmpl.find('}', i);
+        if (close == std::string_view::npos) {
+            hard_fault(FaultType::IllegalOp,
+                       std::format("STRFMT unterminated placeholder at pc={}", pc));
+        }
+        std::string_view spec = tmpl.substr(i + 1, close - i - 1);
+        if (next >= argc) {
+            hard_fault(FaultType::IllegalOp,
+                       std::format("STRFMT template wants more than {} arguments at pc={}",
+                                   argc, pc));
+        }
+        int64_t v = args[next++];
+        if (spec.empty()) {
+            append_int(out, v, 10);
+        } else if (spec == "x") {
+            append_int(out, v, 16);
+        } else if (spec == "b") {
+            append_int(out, v, 2);
+        } else if (spec == "c") {
+            out += static_cast<char>(v);
+        } else if (spec == "s") {
+            out.append(string_at(v, "STRFMT"));
+        } else {
+            hard_fault(FaultType::IllegalOp,
+                       std::format("STRFMT unknown placeholder {{{}}} at pc={}", spec, pc));
+        }
+        i = close;
+    }
+    regs[dst] = intern_string(out);
+}
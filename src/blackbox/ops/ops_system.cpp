@@ -3,19 +3,18 @@
 //
 
 #include "ops_system.hpp"
-#include "../../utils/random_utils.hpp"
+#include "../process.hpp"
+#include "../terminal.hpp"
 #include "../vm.hpp"
+#include <algorithm>
 #include <cstdlib>
 #include <format>
 #include <print>
 
 
 #ifdef _WIN32
-#include <conio.h>
 #include <windows.h>
 #else
-#include <fcntl.h>
-#include <termios.h>
 #include <unistd.h>
 #endif
 
@@ -33,9 +32,109 @@ void VM::op_exec() {
     std::string cmd(reinterpret_cast<const char*>(prog.code.data() + pc), static_cast<size_t>(len));
     pc += static_cast<size_t>(len);
 
+    // the child shares the tty, so it gets the settings the program started with
+    terminal::LineMode line_mode;
     regs[dst] = static_cast<int64_t>(std::system(cmd.c_str()));
 }
 
+// reads the inline command of EXECX/EXECBG as an argv; NOSHELL payloads are NUL-separated
+std::vector<std::string> VM::fetch_command(uint8_t flags, std::string_view opname) {
+    uint32_t len = fetch_u32();
+    if (pc + static_cast<size_t>(len) > prog.code.size()) {
+        hard_fault(FaultType::OutOfBounds,
+                   std::format("{} command past end of code at pc={}", opname, pc));
+    }
+    std::string_view cmd(reinterpret_cast<const char*>(prog.code.data() + pc), static_cast<size_t>(len));
+    pc += static_cast<size_t>(len);
+
+    if (!(flags & EXEC_NOSHELL)) {
+        return process::shell_argv(cmd);
+    }
+    std::vector<std::string> argv;
+    size_t start = 0;
+    for (;;) {
+        size_t end = cmd.find('\0', start);
+        argv.emplace_back(cmd.substr(start, end - start));
+        if (end == std::string_view::npos) {
+            break;
+        }
+        start = end + 1;
+    }
+    if (argv.front().empty()) {
+        hard_fault(FaultType::IllegalOp, std::format("{} with empty program at pc={}", opname, pc));
+    }
+    return argv;
+}
+
+void VM::op_execx() {
+    require_privileged("EXECX");
+
+    uint8_t flags = fetch_u8();
+    size_t dst = fetch_reg();
+    size_t out = fetch_reg();
+    auto argv = fetch_command(flags, "EXECX");
+
+    std::string output;
+    terminal::LineMode line_mode;
+    int status = process::run(argv, (flags & EXEC_CAPTURE) ? &output : nullptr);
+    if (flags & EXEC_CAPTURE) {
+        regs[out] = intern_string(output);
+    }
+    regs[dst] = status;
+}
+
+void VM::op_execbg() {
+    require_privileged("EXECBG");
+
+    uint8_t flags = fetch_u8();
+    size_t dst = fetch_reg();
+    auto argv = fetch_command(flags, "EXECBG");
+
+    terminal::LineMode line_mode;
+    int64_t handle = process::spawn(argv);
+    if (handle < 0) {
+        regs[dst] = -1;
+        return;
+    }
+    auto slot = std::find(jobs.begin(), jobs.end(), -1);
+    if (slot == jobs.end()) {
+        slot = jobs.insert(jobs.end(), handle);
+    } else {
+        *slot = handle;
+    }
+    regs[dst] = slot - jobs.begin();
+}
+
+// waits for an EXECBG job; other coroutines keep running while the child is busy
+void VM::op_execwait() {
+    require_privileged("EXECWAIT");
+
+    size_t dst = fetch_reg();
+    int64_t job = regs[fetch_reg()];
+    if (job < 0 || static_cast<size_t>(job) >= jobs.size() || jobs[job] < 0) {
+        raise_fault(FaultType::OutOfBounds,
+                    std::format("EXECWAIT on unknown job {} at pc={}", job, pc));
+        return;
+    }
+
+    int status;
+    if (live_coroutines > 1) {
+        auto done = process::try_wait(jobs[job]);
+        if (!done) {
+            if (yield_to_retry()) {
+                return;
+            }
+            status = process::wait(jobs[job]);
+        } else {
+            status = *done;
+        }
+    } else {
+        status = process::wait(jobs[job]);
+    }
+    jobs[job] = -1;
+    regs[dst] = status;
+}
+
 static void sleep_ms(uint64_t ms) {
 #ifdef _WIN32
     Sleep(static_cast<DWORD>(ms));
@@ -49,7 +148,13 @@ static void sleep_ms(uint64_t ms) {
 
 void VM::op_sleep() {
     int64_t ms = read_operand();
-    sleep_ms(ms < 0 ? 0 : static_cast<uint64_t>(ms));
+    uint64_t duration = ms < 0 ? 0 : static_cast<uint64_t>(ms);
+    // park the coroutine on the timer heap instead of blocking the whole VM
+    if (live_coroutines > 1) {
+        sleep_current(duration);
+        return;
+    }
+    sleep_ms(duration);
 }
 
 void VM::op_rand() {
@@ -61,47 +166,30 @@ void VM::op_rand() {
         std::swap(min, max);
     }
 
-    uint64_t r = blackbox::tools::get_true_random();
+    regs[reg] = rng.uniform(min, max);
+}
 
-    uint64_t range = static_cast<uint64_t>(max - min) + 1;
-    if (range == 0) {
-        regs[reg] = static_cast<int64_t>(r);
-    } else {
-        regs[reg] = min + static_cast<int64_t>(r % range);
+void VM::op_randfill() {
+    size_t base = fetch_heap_base("RANDFILL");
+    int64_t count = read_operand();
+    int64_t min = fetch_i64();
+    int64_t max = fetch_i64();
+    if (count < 0) {
+        hard_fault(FaultType::OutOfBounds, std::format("RANDFILL negative count at pc={}", pc));
+    }
+    if (min > max) {
+        std::swap(min, max);
+    }
+    check_heap_range(base, static_cast<size_t>(count), true, "RANDFILL");
+    int64_t* slots = op_stack.data() + base;
+    for (size_t i = 0; i < static_cast<size_t>(count); i++) {
+        slots[i] = rng.uniform(min, max);
     }
 }
 
 void VM::op_getkey() {
     size_t reg = fetch_reg();
-
-#ifdef _WIN32
-    if (_kbhit()) {
-        regs[reg] = static_cast<int64_t>(_getch());
-    } else {
-        regs[reg] = -1;
-    }
-#else
-    struct termios oldt, newt;
-    tcgetattr(STDIN_FILENO, &oldt);
-    newt = oldt;
-    newt.c_lflag &= ~static_cast<tcflag_t>(ICANON | ECHO);
-    tcsetattr(STDIN_FILENO, TCSANOW, &newt);
-
-    int oldf = fcntl(STDIN_FILENO, F_GETFL, 0);
-    fcntl(STDIN_FILENO, F_SETFL, oldf | O_NONBLOCK);
-
-    int ch = std::getchar();
-
-    tcsetattr(STDIN_FILENO, TCSANOW, &oldt);
-    fcntl(STDIN_FILENO, F_SETFL, oldf);
-
-    if (ch == EOF) {
-        clearerr(stdin);
-        regs[reg] = -1;
-    } else {
-        regs[reg] = static_cast<int64_t>(ch);
-    }
-#endif
+    regs[reg] = stdin_buf.buffered() ? stdin_buf.get() : terminal::poll_key();
 }
 
 void VM::op_clrscr() {
@@ -124,8 +212,7 @@ void VM::op_getarg() {
     }
 
     std::string_view arg(host_argv[idx]);
-    uint32_t handle = prog.strings.intern(arg);
-    regs[reg] = static_cast<int64_t>(handle);
+    regs[reg] = intern_string(arg);
 }
 
 void VM::op_getenv() {
@@ -148,6 +235,5 @@ void VM::op_getenv() {
         return;
     }
 
-    uint32_t handle = prog.strings.intern(std::string_view(val));
-    regs[reg] = static_cast<int64_t>(handle);
+    regs[reg] = intern_string(std::string_view(val));
 }
\ No newline at end of file
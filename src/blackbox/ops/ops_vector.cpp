@@ -0,0 +1,89 @@
+//
+// Created by User on 2026-04-18.
+//
+
+#include "ops_vector.hpp"
+#include "../simd.hpp"
+#include "../vm.hpp"
+#include <format>
+
+// vector instructions work on runs of int64 heap slots, one dispatch per run instead of per
+// element; the arithmetic itself runs in the simd kernels
+
+namespace {
+// true when [a, a + n) and [b, b + n) share a slot without starting at the same one
+bool partial_overlap(size_t a, size_t b, size_t n) {
+    return a != b && a < b + n && b < a + n;
+}
+} // namespace
+
+void VM::vector_map(simd::VecOp op, std::string_view opname) {
+    size_t dst = fetch_heap_base(opname);
+    size_t a = fetch_heap_base(opname);
+    size_t b = fetch_heap_base(opname);
+    int64_t len = read_operand();
+    if (len < 0) {
+        hard_fault(FaultType::OutOfBounds, std::format("{} negative length at pc={}", opname, pc));
+    }
+    auto n = static_cast<size_t>(len);
+    check_heap_range(a, n, false, opname);
+    check_heap_range(b, n, false, opname);
+    check_heap_range(dst, n, true, opname);
+    // the kernels read a block before writing it, so only an exact alias is safe in place
+    if (partial_overlap(dst, a, n) || partial_overlap(dst, b, n)) {
+        hard_fault(FaultType::IllegalOp,
+                   std::format("{} destination partially overlaps a source at pc={}", opname, pc));
+    }
+    int64_t* slots = op_stack.data();
+    simd::map_i64(op, slots + dst, slots + a, slots + b, n);
+}
+
+void VM::op_vadd() {
+    vector_map(simd::VecOp::Add, "VADD");
+}
+
+void VM::op_vsub() {
+    vector_map(simd::VecOp::Sub, "VSUB");
+}
+
+void VM::op_vmul() {
+    vector_map(simd::VecOp::Mul, "VMUL");
+}
+
+void VM::op_vand() {
+    vector_map(simd::VecOp::And, "VAND");
+}
+
+void VM::op_vmin() {
+    vector_map(simd::VecOp::Min, "VMIN");
+}
+
+void VM::op_vmax() {
+    vector_map(simd::VecOp::Max, "VMAX");
+}
+
+void VM::op_vsum() {
+    size_t dst = fetch_reg();
+    size_t base = fetch_heap_base("VSUM");
+    int64_t len = read_operand();
+    if (len < 0) {
+        hard_fault(FaultType::OutOfBounds, std::format("VSUM negative length at pc={}", pc));
+    }
+    auto n = static_cast<size_t>(len);
+    check_heap_range(base, n, false, "VSUM");
+    regs[dst] = simd::sum_i64(op_stack.data() + base, n);
+}
+
+void VM::op_vdot() {
+    size_t dst = fetch_reg();
+    size_t a = fetch_heap_base("VDOT");
+    size_t b = fetch_heap_base("VDOT");
+    int64_t len = read_operand();
+    if (len < 0) {
+        hard_fault(FaultType::OutOfBounds, std::format("VDOT negative length at pc={}", pc));
+    }
+    auto n = static_cast<size_t>(len);
+    check_heap_range(a, n, false, "VDOT");
+    check_heap_range(b, n, false, "VDOT");
+    regs[dst] = simd::dot_i64(op_stack.data() + a, op_stack.data() + b, n);
+}
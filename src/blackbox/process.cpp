@@ -0,0 +1,213 @@
+//
+// Created by User on 2026-04-18.
+//
+
+#include "process.hpp"
+#include <array>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <process.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
+
+namespace process {
+namespace {
+std::vector<char*> c_argv(const std::vector<std::string>& argv) {
+    std::vector<char*> out;
+    out.reserve(argv.size() + 1);
+    for (const auto& a : argv) {
+        out.push_back(const_cast<char*>(a.c_str()));
+    }
+    out.push_back(nullptr);
+    return out;
+}
+
+#ifndef _WIN32
+// PIPE ignores SIGPIPE in the VM; children get the default disposition back
+struct SpawnAttr {
+    posix_spawnattr_t attr;
+
+    SpawnAttr() {
+        posix_spawnattr_init(&attr);
+        sigset_t defaults;
+        sigemptyset(&defaults);
+        sigaddset(&defaults, SIGPIPE);
+        posix_spawnattr_setsigdefault(&attr, &defaults);
+        posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGDEF);
+    }
+    ~SpawnAttr() { posix_spawnattr_destroy(&attr); }
+};
+
+// close-on-exec from the start, so a child spawned by another VM thread in the meantime cannot
+// inherit the write end and keep the capture read from ever seeing EOF. adddup2 clears the flag
+// on the child's stdout
+int cloexec_pipe(int fds[2]) {
+#ifdef __linux__
+    return pipe2(fds, O_CLOEXEC);
+#else
+    if (pipe(fds) != 0) {
+        return -1;
+    }
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    return 0;
+#endif
+}
+
+int exit_code(int status) {
+    if (WIFEXITED(status)) {
+        return WEXITSTATUS(status);
+    }
+    if (WIFSIGNALED(status)) {
+        return 128 + WTERMSIG(status);
+    }
+    return -1;
+}
+
+int wait_pid(pid_t pid, int flags, bool& done) {
+    int status = 0;
+    pid_t r;
+    do {
+        r = waitpid(pid, &status, flags);
+    } while (r < 0 && errno == EINTR);
+    done = r != 0;
+    return r < 0 ? -1 : exit_code(status);
+}
+#endif
+} // namespace
+
+std::vector<std::string> shell_argv(std::string_view cmd) {
+#ifdef _WIN32
+    return {"cmd.exe", "/c", std::string(cmd)};
+#else
+    return {"/bin/sh", "-c", std::string(cmd)};
+#endif
+}
+
+#ifdef _WIN32
+// the CRT has no pipe-to-child spawn, so captured commands go through the shell
+int run(const std::vector<std::string>& argv, std::string* output) {
+    auto args = c_argv(argv);
+    if (!output) {
+        intptr_t r = _spawnvp(_P_WAIT, args[0], args.data());
+        return r < 0 ? -1 : static_cast<int>(r);
+    }
+    std::string cmd;
+    for (const auto& a : argv) {
+        cmd += cmd.empty() ? "" : " ";
+        cmd += a;
+    }
+    FILE* pipe = _popen(cmd.c_str(), "rb");
+    if (!pipe) {
+        return -1;
+    }
+    std::array<char, 64 * 1024> chunk;
+    size_t n;
+    while ((n = std::fread(chunk.data(), 1, chunk.size(), pipe)) > 0) {
+        output->append(chunk.data(), n);
+    }
+    return _pclose(pipe);
+}
+
+int64_t spawn(const std::vector<std::string>& argv) {
+    auto args = c_argv(argv);
+    intptr_t h = _spawnvp(_P_NOWAIT, args[0], args.data());
+    return h == -1 ? -1 : static_cast<int64_t>(h);
+}
+
+std::optional<int> try_wait(int64_t handle) {
+    if (WaitForSingleObject(reinterpret_cast<HANDLE>(handle), 0) == WAIT_TIMEOUT) {
+        return std::nullopt;
+    }
+    return wait(handle);
+}
+
+int wait(int64_t handle) {
+    int status = 0;
+    if (_cwait(&status, static_cast<intptr_t>(handle), 0) == -1) {
+        return -1;
+    }
+    return status;
+}
+#else
+int run(const std::vector<std::string>& argv, std::string* output) {
+    auto args = c_argv(argv);
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+
+    int fds[2] = {-1, -1};
+    if (output) {
+        if (cloexec_pipe(fds) != 0) {
+            posix_spawn_file_actions_destroy(&actions);
+            return -1;
+        }
+        posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+        posix_spawn_file_actions_addclose(&actions, fds[0]);
+        posix_spawn_file_actions_addclose(&actions, fds[1]);
+    }
+
+    std::fflush(stdout);
+    SpawnAttr spawn_attr;
+    pid_t pid;
+    int rc = posix_spawnp(&pid, args[0], &actions, &spawn_attr.attr, args.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+
+    if (output) {
+        close(fds[1]);
+        if (rc == 0) {
+            std::array<char, 64 * 1024> chunk;
+            for (;;) {
+                ssize_t n = read(fds[0], chunk.data(), chunk.size());
+                if (n > 0) {
+                    output->append(chunk.data(), static_cast<size_t>(n));
+                } else if (n == 0 || errno != EINTR) {
+                    break;
+                }
+            }
+        }
+        close(fds[0]);
+    }
+    if (rc != 0) {
+        return -1;
+    }
+    bool done;
+    return wait_pid(pid, 0, done);
+}
+
+int64_t spawn(const std::vector<std::string>& argv) {
+    auto args = c_argv(argv);
+    std::fflush(stdout);
+    SpawnAttr spawn_attr;
+    pid_t pid;
+    if (posix_spawnp(&pid, args[0], nullptr, &spawn_attr.attr, args.data(), environ) != 0) {
+        return -1;
+    }
+    return pid;
+}
+
+std::optional<int> try_wait(int64_t handle) {
+    bool done;
+    int code = wait_pid(static_cast<pid_t>(handle), WNOHANG, done);
+    if (!done) {
+        return std::nullopt;
+    }
+    return code;
+}
+
+int wait(int64_t handle) {
+    bool done;
+    return wait_pid(static_cast<pid_t>(handle), 0, done);
+}
+#endif
+
+} // namespace process
@@ -0,0 +1,33 @@
+//
+// Created by User on 2026-04-18.
+//
+
+#ifndef BLACKBOX_PROCESS_HPP
+#define BLACKBOX_PROCESS_HPP
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// child processes for EXECX/EXECBG. exit codes are the child's own status, 128 + signal when it
+// was killed, and -1 when it could not be started
+namespace process {
+
+// argv that runs cmd through the platform shell
+std::vector<std::string> shell_argv(std::string_view cmd);
+
+// runs argv[0] (searched on PATH) to completion; stdout goes into *output when given
+int run(const std::vector<std::string>& argv, std::string* output);
+
+// starts argv without waiting; the handle is only meaningful to try_wait/wait, -1 on failure
+int64_t spawn(const std::vector<std::string>& argv);
+
+// exit code once the child has finished, nullopt while it is still running
+std::optional<int> try_wait(int64_t handle);
+int wait(int64_t handle);
+
+} // namespace process
+
+#endif // BLACKBOX_PROCESS_HPP
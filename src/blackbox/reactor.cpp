@@ -0,0 +1,149 @@
+//
+// Created by User on 2026-04-18.
+//
+
+#include "reactor.hpp"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+#ifndef _WIN32
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace {
+#ifndef _WIN32
+short poll_events(uint8_t interest) {
+    return static_cast<short>(((interest & Reactor::READABLE) ? POLLIN : 0) |
+                              ((interest & Reactor::WRITABLE) ? POLLOUT : 0));
+}
+#endif
+} // namespace
+
+Reactor::~Reactor() {
+#ifdef __linux__
+    if (epoll_fd >= 0) {
+        close(epoll_fd);
+    }
+#endif
+}
+
+void Reactor::add(int os_fd, uint8_t interest, uint32_t tag) {
+    entries.push_back(Entry{.os_fd = os_fd, .interest = interest, .tag = tag});
+}
+
+void Reactor::remove(int os_fd) {
+    auto it = std::find_if(entries.begin(), entries.end(),
+                           [&](const Entry& e) { return e.os_fd == os_fd; });
+    if (it == entries.end()) {
+        return;
+    }
+#ifdef __linux__
+    if (it->armed) {
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, os_fd, nullptr);
+    }
+#endif
+    entries.erase(it);
+}
+
+size_t Reactor::wait(std::span<const uint32_t> want, int timeout_ms, std::span<uint32_t> ready) {
+    auto wanted = [&](uint32_t tag) { return std::find(want.begin(), want.end(), tag) != want.end(); };
+    size_t n = 0;
+
+#if defined(__linux__)
+    if (epoll_fd < 0) {
+        epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    }
+    bool any_armed = false;
+    for (auto& e : entries) {
+        bool arm = wanted(e.tag);
+        if (arm && !e.armed) {
+            epoll_event ev{};
+            ev.events = ((e.interest & READABLE) ? EPOLLIN : 0u) |
+                        ((e.interest & WRITABLE) ? EPOLLOUT : 0u);
+            ev.data.u32 = e.tag;
+            if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, e.os_fd, &ev) != 0) {
+                // regular files cannot be watched and are always ready
+                if (n < ready.size()) {
+                    ready[n++] = e.tag;
+                }
+                continue;
+            }
+            e.armed = true;
+        } else if (!arm && e.armed) {
+            epoll_ctl(epoll_fd, EPOLL_CTL_DEL, e.os_fd, nullptr);
+            e.armed = false;
+        }
+        any_armed |= e.armed;
+    }
+    if (n > 0) {
+        timeout_ms = 0;
+    }
+    if (!any_armed) {
+        return n;
+    }
+    std::array<epoll_event, 64> events;
+    int max = static_cast<int>(std::min(events.size(), ready.size() - n));
+    if (max == 0) {
+        return n;
+    }
+    int got;
+    do {
+        got = epoll_wait(epoll_fd, events.data(), max, timeout_ms);
+    } while (got < 0 && errno == EINTR);
+    for (int i = 0; i < got; i++) {
+        ready[n++] = events[i].data.u32;
+    }
+    return n;
+#elif defined(_WIN32)
+    (void)timeout_ms;
+    for (const auto& e : entries) {
+        if (n < ready.size() && wanted(e.tag)) {
+            ready[n++] = e.tag;
+        }
+    }
+    return n;
+#else
+    std::vector<pollfd> set;
+    std::vector<uint32_t> tags;
+    for (const auto& e : entries) {
+        if (wanted(e.tag)) {
+            set.push_back(pollfd{.fd = e.os_fd, .events = poll_events(e.interest), .revents = 0});
+            tags.push_back(e.tag);
+        }
+    }
+    if (set.empty()) {
+        return 0;
+    }
+    int rc;
+    do {
+        rc = poll(set.data(), static_cast<nfds_t>(set.size()), timeout_ms);
+    } while (rc < 0 && errno == EINTR);
+    for (size_t i = 0; i < set.size() && n < ready.size(); i++) {
+        if (set[i].revents) {
+            ready[n++] = tags[i];
+        }
+    }
+    return n;
+#endif
+}
+
+bool Reactor::wait_one(int os_fd, uint8_t interest, int timeout_ms) {
+#ifdef _WIN32
+    (void)os_fd;
+    (void)interest;
+    (void)timeout_ms;
+    return true;
+#else
+    pollfd p{.fd = os_fd, .events = poll_events(interest), .revents = 0};
+    int rc;
+    do {
+        rc = poll(&p, 1, timeout_ms);
+    } while (rc < 0 && errno == EINTR);
+    return rc > 0;
+#endif
+}
@@ -0,0 +1,49 @@
+//
+// Created by User on 2026-04-18.
+//
+
+#ifndef BLACKBOX_REACTOR_HPP
+#define BLACKBOX_REACTOR_HPP
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// readiness of a VM's pipe and FIFO descriptors for POLL. on Linux the epoll interest set is
+// kept between calls and only changes when a POLL asks for a different set of fds, so a loop
+// polling the same fds costs one epoll_wait. other systems build a poll() set per call. Windows
+// has no readiness API for anonymous pipes, so every fd reports ready there
+class Reactor {
+  public:
+    static constexpr uint8_t READABLE = 0x01;
+    static constexpr uint8_t WRITABLE = 0x02;
+
+    Reactor() = default;
+    ~Reactor();
+
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    void add(int os_fd, uint8_t interest, uint32_t tag);
+    void remove(int os_fd);
+
+    // waits up to timeout_ms (negative waits forever) until any fd whose tag is in want is ready,
+    // and stores the tags of the ready ones. returns how many were stored
+    size_t wait(std::span<const uint32_t> want, int timeout_ms, std::span<uint32_t> ready);
+
+    // true once a single fd is ready or the timeout passes, for blocking reads and writes on
+    // non-blocking fds
+    static bool wait_one(int os_fd, uint8_t interest, int timeout_ms);
+
+  private:
+    struct Entry {
+        int os_fd;
+        uint8_t interest;
+        uint32_t tag;
+        bool armed = false; // in the epoll set
+    };
+    std::vector<Entry> entries;
+    int epoll_fd = -1;
+};
+
+#endif // BLACKBOX_REACTOR_HPP
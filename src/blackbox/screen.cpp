@@ -0,0 +1,54 @@
+//
+// Created by User on 2026-04-18.
+//
+
+#include "screen.hpp"
+#include <format>
+#include <iterator>
+
+void Screen::init(size_t width, size_t height) {
+    w = width;
+    h = height;
+    back.assign(w * h, ' ');
+    front.assign(w * h, ' ');
+    full_redraw = true;
+}
+
+void Screen::blit(std::span<const int64_t> cells) {
+    for (size_t i = 0; i < back.size(); i++) {
+        back[i] = cell(cells[i]);
+    }
+}
+
+void Screen::flush(std::FILE* out) {
+    frame.clear();
+    if (full_redraw) {
+        frame += "\x1b[2J";
+    }
+    for (size_t y = 0; y < h; y++) {
+        // cursor position after the last cell written on this row, w when none
+        size_t cursor = w;
+        for (size_t x = 0; x < w; x++) {
+            size_t i = y * w + x;
+            char ch = back[i];
+            if (ch == front[i]) {
+                continue;
+            }
+            if (x != cursor) {
+                std::format_to(std::back_inserter(frame), "\x1b[{};{}H", y + 1, x + 1);
+            }
+            frame += ch;
+            front[i] = ch;
+            cursor = x + 1;
+        }
+    }
+    full_redraw = false;
+    if (frame.empty()) {
+        return;
+    }
+    // park the cursor below the screen so ordinary output lands there
+    std::format_to(std::back_inserter(frame), "\x1b[{};1H", h + 1);
+    std::fflush(out);
+    std::fwrite(frame.data(), 1, frame.size(), out);
+    std::fflush(out);
+}
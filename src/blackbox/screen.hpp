@@ -0,0 +1,39 @@
+//
+// Created by User on 2026-04-18.
+//
+
+#ifndef BLACKBOX_SCREEN_HPP
+#define BLACKBOX_SCREEN_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <string>
+#include <vector>
+
+// character-cell frame buffer. the program draws into the back buffer; flush() compares it with
+// what the terminal already shows and writes only the changed cells, in one write
+class Screen {
+  public:
+    void init(size_t width, size_t height);
+    bool ready() const { return w != 0; }
+    size_t width() const { return w; }
+    size_t height() const { return h; }
+
+    void put(size_t x, size_t y, int64_t ch) { back[y * w + x] = cell(ch); }
+    // cells holds width * height character codes in row-major order
+    void blit(std::span<const int64_t> cells);
+    void flush(std::FILE* out);
+
+  private:
+    size_t w = 0, h = 0;
+    std::vector<char> back;
+    std::vector<char> front; // what the terminal currently shows
+    bool full_redraw = true;  // clear the terminal first; front then matches it
+    std::string frame;
+
+    // anything that would move the cursor is drawn as a blank
+    static char cell(int64_t ch) { return ch >= 0x20 && ch < 0x7F ? static_cast<char>(ch) : ' '; }
+};
+
+#endif // BLACKBOX_SCREEN_HPP
@@ -0,0 +1,451 @@
+//
+// Created by User on 2026-04-18.
+//
+
+#include "simd.hpp"
+#include <bit>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BLACKBOX_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace simd {
+namespace {
+
+size_t find_byte_scalar(const char* p, size_t n, char c) {
+    const void* hit = std::memchr(p, c, n);
+    return hit ? static_cast<size_t>(static_cast<const char*>(hit) - p) : n;
+}
+
+#ifndef BLACKBOX_SIMD_X86
+size_t find_scalar(std::string_view hay, std::string_view needle) {
+    return hay.find(needle);
+}
+#endif
+
+size_t find_i64_scalar(const int64_t* p, size_t n, int64_t v) {
+    for (size_t i = 0; i < n; i++) {
+        if (p[i] == v) {
+            return i;
+        }
+    }
+    return n;
+}
+
+// arithmetic goes through uint64_t so overflow wraps like the scalar ALU instead of being UB
+int64_t wrap_add(int64_t a, int64_t b) {
+    return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+}
+int64_t wrap_sub(int64_t a, int64_t b) {
+    return static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b));
+}
+int64_t wrap_mul(int64_t a, int64_t b) {
+    return static_cast<int64_t>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b));
+}
+
+void map_i64_scalar(VecOp op, int64_t* dst, const int64_t* a, const int64_t* b, size_t n) {
+    switch (op) {
+        case VecOp::Add:
+            for (size_t i = 0; i < n; i++) {
+                dst[i] = wrap_add(a[i], b[i]);
+            }
+            break;
+        case VecOp::Sub:
+            for (size_t i = 0; i < n; i++) {
+                dst[i] = wrap_sub(a[i], b[i]);
+            }
+            break;
+        case VecOp::Mul:
+            for (size_t i = 0; i < n; i++) {
+                dst[i] = wrap_mul(a[i], b[i]);
+            }
+            break;
+        case VecOp::And:
+            for (size_t i = 0; i < n; i++) {
+                dst[i] = a[i] & b[i];
+            }
+            break;
+        case VecOp::Min:
+            for (size_t i = 0; i < n; i++) {
+                dst[i] = a[i] < b[i] ? a[i] : b[i];
+            }
+            break;
+        case VecOp::Max:
+            for (size_t i = 0; i < n; i++) {
+                dst[i] = a[i] > b[i] ? a[i] : b[i];
+            }
+            break;
+    }
+}
+
+int64_t sum_i64_scalar(const int64_t* p, size_t n) {
+    int64_t sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        sum = wrap_add(sum, p[i]);
+    }
+    return sum;
+}
+
+int64_t dot_i64_scalar(const int64_t* a, const int64_t* b, size_t n) {
+    int64_t sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        sum = wrap_add(sum, wrap_mul(a[i], b[i]));
+    }
+    return sum;
+}
+
+#ifdef BLACKBOX_SIMD_X86
+
+// substring search compares the needle's first and last byte against every position of a block
+// at once and only runs memcmp where both match (Mula's "SIMD-friendly" generic search), so a
+// scan does one compare pass per block instead of one memcmp per byte
+
+size_t find_byte_sse2(const char* p, size_t n, char c) {
+    const __m128i want = _mm_set1_epi8(c);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, want)));
+        if (mask != 0) {
+            return i + static_cast<size_t>(std::countr_zero(mask));
+        }
+    }
+    return i + find_byte_scalar(p + i, n - i, c);
+}
+
+size_t find_sse2(std::string_view hay, std::string_view needle) {
+    size_t n = hay.size();
+    size_t k = needle.size();
+    const char* h = hay.data();
+    const __m128i first = _mm_set1_epi8(needle.front());
+    const __m128i last = _mm_set1_epi8(needle.back());
+    size_t i = 0;
+    for (; i + k - 1 + 16 <= n; i += 16) {
+        __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i));
+        __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i + k - 1));
+        __m128i eq =
+            _mm_and_si128(_mm_cmpeq_epi8(first, block_first), _mm_cmpeq_epi8(last, block_last));
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(eq));
+        while (mask != 0) {
+            size_t at = i + static_cast<size_t>(std::countr_zero(mask));
+            if (std::memcmp(h + at + 1, needle.data() + 1, k - 2) == 0) {
+                return at;
+            }
+            mask &= mask - 1;
+        }
+    }
+    size_t rest = hay.substr(i).find(needle);
+    return rest == std::string_view::npos ? rest : i + rest;
+}
+
+// no 64-bit compare before SSE4.1: two 32-bit halves are equal when both compare equal
+size_t find_i64_sse2(const int64_t* p, size_t n, int64_t v) {
+    const __m128i want = _mm_set1_epi64x(v);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        __m128i eq32 = _mm_cmpeq_epi32(block, want);
+        __m128i eq64 = _mm_and_si128(eq32, _mm_shuffle_epi32(eq32, _MM_SHUFFLE(2, 3, 0, 1)));
+        auto mask = static_cast<uint32_t>(_mm_movemask_pd(_mm_castsi128_pd(eq64)));
+        if (mask != 0) {
+            return i + static_cast<size_t>(std::countr_zero(mask));
+        }
+    }
+    return i + find_i64_scalar(p + i, n - i, v);
+}
+
+__attribute__((target("avx2"))) size_t find_byte_avx2(const char* p, size_t n, char c) {
+    const __m256i want = _mm256_set1_epi8(c);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, want)));
+        if (mask != 0) {
+            return i + static_cast<size_t>(std::countr_zero(mask));
+        }
+    }
+    return i + find_byte_sse2(p + i, n - i, c);
+}
+
+__attribute__((target("avx2"))) size_t find_avx2(std::string_view hay, std::string_view needle) {
+    size_t n = hay.size();
+    size_t k = needle.size();
+    const char* h = hay.data();
+    const __m256i first = _mm256_set1_epi8(needle.front());
+    const __m256i last = _mm256_set1_epi8(needle.back());
+    size_t i = 0;
+    for (; i + k - 1 + 32 <= n; i += 32) {
+        __m256i block_first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + i));
+        __m256i block_last = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + i + k - 1));
+        __m256i eq = _mm256_and_si256(_mm256_cmpeq_epi8(first, block_first),
+                                      _mm256_cmpeq_epi8(last, block_last));
+        auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(eq));
+        while (mask != 0) {
+            size_t at = i + static_cast<size_t>(std::countr_zero(mask));
+            if (std::memcmp(h + at + 1, needle.data() + 1, k - 2) == 0) {
+                return at;
+            }
+            mask &= mask - 1;
+        }
+    }
+    size_t rest = find_sse2(hay.substr(i), needle);
+    return rest == std::string_view::npos ? rest : i + rest;
+}
+
+__attribute__((target("avx2"))) size_t find_i64_avx2(const int64_t* p, size_t n, int64_t v) {
+    const __m256i want = _mm256_set1_epi64x(v);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        auto mask = static_cast<uint32_t>(
+            _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(block, want))));
+        if (mask != 0) {
+            return i + static_cast<size_t>(std::countr_zero(mask));
+        }
+    }
+    return i + find_i64_sse2(p + i, n - i, v);
+}
+
+// AVX2 has no 64-bit multiply, so Mul and dot products stay scalar at this level
+__attribute__((target("avx2"))) void map_i64_avx2(VecOp op, int64_t* dst, const int64_t* a,
+                                                  const int64_t* b, size_t n) {
+    size_t i = 0;
+    if (op != VecOp::Mul) {
+        for (; i + 4 <= n; i += 4) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+            __m256i r;
+            switch (op) {
+                case VecOp::Add:
+                    r = _mm256_add_epi64(x, y);
+                    break;
+                case VecOp::Sub:
+                    r = _mm256_sub_epi64(x, y);
+                    break;
+                case VecOp::And:
+                    r = _mm256_and_si256(x, y);
+                    break;
+                case VecOp::Min:
+                    r = _mm256_blendv_epi8(x, y, _mm256_cmpgt_epi64(x, y));
+                    break;
+                default:
+                    r = _mm256_blendv_epi8(y, x, _mm256_cmpgt_epi64(x, y));
+                    break;
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), r);
+        }
+    }
+    map_i64_scalar(op, dst + i, a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2"))) int64_t sum_i64_avx2(const int64_t* p, size_t n) {
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm256_add_epi64(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)));
+    }
+    alignas(32) int64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    return wrap_add(sum_i64_scalar(lanes, 4), sum_i64_scalar(p + i, n - i));
+}
+
+#ifdef BLACKBOX_USE_AVX512
+__attribute__((target("avx512f,avx512bw"))) size_t find_byte_avx512(const char* p, size_t n,
+                                                                    char c) {
+    const __m512i want = _mm512_set1_epi8(c);
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __m512i block = _mm512_loadu_si512(p + i);
+        uint64_t mask = _mm512_cmpeq_epi8_mask(block, want);
+        if (mask != 0) {
+            return i + static_cast<size_t>(std::countr_zero(mask));
+        }
+    }
+    return i + find_byte_avx2(p + i, n - i, c);
+}
+
+__attribute__((target("avx512f,avx512bw"))) size_t find_avx512(std::string_view hay,
+                                                               std::string_view needle) {
+    size_t n = hay.size();
+    size_t k = needle.size();
+    const char* h = hay.data();
+    const __m512i first = _mm512_set1_epi8(needle.front());
+    const __m512i last = _mm512_set1_epi8(needle.back());
+    size_t i = 0;
+    for (; i + k - 1 + 64 <= n; i += 64) {
+        __m512i block_first = _mm512_loadu_si512(h + i);
+        __m512i block_last = _mm512_loadu_si512(h + i + k - 1);
+        uint64_t mask = _mm512_cmpeq_epi8_mask(first, block_first) &
+                        _mm512_cmpeq_epi8_mask(last, block_last);
+        while (mask != 0) {
+            size_t at = i + static_cast<size_t>(std::countr_zero(mask));
+            if (std::memcmp(h + at + 1, needle.data() + 1, k - 2) == 0) {
+                return at;
+            }
+            mask &= mask - 1;
+        }
+    }
+    size_t rest = find_avx2(hay.substr(i), needle);
+    return rest == std::string_view::npos ? rest : i + rest;
+}
+
+__attribute__((target("avx512f"))) size_t find_i64_avx512(const int64_t* p, size_t n, int64_t v) {
+    const __m512i want = _mm512_set1_epi64(v);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint32_t mask = _mm512_cmpeq_epi64_mask(_mm512_loadu_si512(p + i), want);
+        if (mask != 0) {
+            return i + static_cast<size_t>(std::countr_zero(mask));
+        }
+    }
+    return i + find_i64_avx2(p + i, n - i, v);
+}
+
+__attribute__((target("avx512f,avx512dq"))) void map_i64_avx512(VecOp op, int64_t* dst,
+                                                                const int64_t* a,
+                                                                const int64_t* b, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512i x = _mm512_loadu_si512(a + i);
+        __m512i y = _mm512_loadu_si512(b + i);
+        __m512i r;
+        switch (op) {
+            case VecOp::Add:
+                r = _mm512_add_epi64(x, y);
+                break;
+            case VecOp::Sub:
+                r = _mm512_sub_epi64(x, y);
+                break;
+            case VecOp::Mul:
+                r = _mm512_mullo_epi64(x, y);
+                break;
+            case VecOp::And:
+                r = _mm512_and_si512(x, y);
+                break;
+            case VecOp::Min:
+                r = _mm512_min_epi64(x, y);
+                break;
+            default:
+                r = _mm512_max_epi64(x, y);
+                break;
+        }
+        _mm512_storeu_si512(dst + i, r);
+    }
+    map_i64_avx2(op, dst + i, a + i, b + i, n - i);
+}
+
+__attribute__((target("avx512f"))) int64_t sum_i64_avx512(const int64_t* p, size_t n) {
+    __m512i acc = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc = _mm512_add_epi64(acc, _mm512_loadu_si512(p + i));
+    }
+    return wrap_add(_mm512_reduce_add_epi64(acc), sum_i64_avx2(p + i, n - i));
+}
+
+__attribute__((target("avx512f,avx512dq"))) int64_t dot_i64_avx512(const int64_t* a,
+                                                                   const int64_t* b, size_t n) {
+    __m512i acc = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512i prod = _mm512_mullo_epi64(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i));
+        acc = _mm512_add_epi64(acc, prod);
+    }
+    return wrap_add(_mm512_reduce_add_epi64(acc), dot_i64_scalar(a + i, b + i, n - i));
+}
+#endif // BLACKBOX_USE_AVX512
+
+#endif // BLACKBOX_SIMD_X86
+
+struct Kernels {
+    Level level;
+    size_t (*find_byte)(const char*, size_t, char);
+    size_t (*find)(std::string_view, std::string_view);
+    size_t (*find_i64)(const int64_t*, size_t, int64_t);
+    void (*map_i64)(VecOp, int64_t*, const int64_t*, const int64_t*, size_t);
+    int64_t (*sum_i64)(const int64_t*, size_t);
+    int64_t (*dot_i64)(const int64_t*, const int64_t*, size_t);
+};
+
+Kernels select_kernels() {
+#ifdef BLACKBOX_SIMD_X86
+    __builtin_cpu_init();
+#ifdef BLACKBOX_USE_AVX512
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+        __builtin_cpu_supports("avx512dq")) {
+        return {Level::AVX512, find_byte_avx512, find_avx512, find_i64_avx512, map_i64_avx512,
+                sum_i64_avx512, dot_i64_avx512};
+    }
+#endif
+    if (__builtin_cpu_supports("avx2")) {
+        return {Level::AVX2, find_byte_avx2, find_avx2, find_i64_avx2, map_i64_avx2,
+                sum_i64_avx2, dot_i64_scalar};
+    }
+    return {Level::SSE2, find_byte_sse2, find_sse2, find_i64_sse2, map_i64_scalar,
+            sum_i64_scalar, dot_i64_scalar};
+#else
+    return {Level::Scalar, find_byte_scalar, find_scalar, find_i64_scalar, map_i64_scalar,
+            sum_i64_scalar, dot_i64_scalar};
+#endif
+}
+
+const Kernels kernels = select_kernels();
+
+} // namespace
+
+Level active_level() {
+    return kernels.level;
+}
+
+const char* level_name(Level level) {
+    switch (level) {
+        case Level::SSE2:
+            return "sse2";
+        case Level::AVX2:
+            return "avx2";
+        case Level::AVX512:
+            return "avx512";
+        default:
+            return "scalar";
+    }
+}
+
+size_t find_byte(const char* p, size_t n, char c) {
+    return kernels.find_byte(p, n, c);
+}
+
+size_t find(std::string_view hay, std::string_view needle) {
+    // the block kernels compare a first and a last byte at different positions, so one-byte
+    // needles go through the byte search
+    if (needle.empty()) {
+        return 0;
+    }
+    if (needle.size() > hay.size()) {
+        return std::string_view::npos;
+    }
+    if (needle.size() == 1) {
+        size_t at = kernels.find_byte(hay.data(), hay.size(), needle.front());
+        return at == hay.size() ? std::string_view::npos : at;
+    }
+    return kernels.find(hay, needle);
+}
+
+size_t find_i64(const int64_t* p, size_t n, int64_t v) {
+    return kernels.find_i64(p, n, v);
+}
+
+void map_i64(VecOp op, int64_t* dst, const int64_t* a, const int64_t* b, size_t n) {
+    kernels.map_i64(op, dst, a, b, n);
+}
+
+int64_t sum_i64(const int64_t* p, size_t n) {
+    return kernels.sum_i64(p, n);
+}
+
+int64_t dot_i64(const int64_t* a, const int64_t* b, size_t n) {
+    return kernels.dot_i64(a, b, n);
+}
+
+} // namespace simd
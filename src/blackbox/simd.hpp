@@ -0,0 +1,42 @@
+//
+// Created by User on 2026-04-18.
+//
+
+#ifndef BLACKBOX_SIMD_HPP
+#define BLACKBOX_SIMD_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// kernels behind the string search, heap scanning and vector opcodes. on x86-64 with GCC or
+// Clang the widest kernel the CPU supports is picked once at startup: AVX-512 (only when built
+// with USE_AVX512), AVX2, else SSE2, which every x86-64 CPU has. elsewhere they are plain loops
+namespace simd {
+
+enum class Level : uint8_t { Scalar, SSE2, AVX2, AVX512 };
+
+Level active_level();
+const char* level_name(Level level);
+
+// index of the first c in [p, p + n), or n
+size_t find_byte(const char* p, size_t n, char c);
+
+// index of the first needle in hay, or std::string_view::npos. an empty needle matches at 0
+size_t find(std::string_view hay, std::string_view needle);
+
+// index of the first v in [p, p + n), or n
+size_t find_i64(const int64_t* p, size_t n, int64_t v);
+
+// element-wise dst[i] = a[i] op b[i]. add, sub and mul wrap around. dst may be a or b, but must
+// not otherwise overlap them
+enum class VecOp : uint8_t { Add, Sub, Mul, And, Min, Max };
+void map_i64(VecOp op, int64_t* dst, const int64_t* a, const int64_t* b, size_t n);
+
+// wrapping sum of [p, p + n) and of a[i] * b[i]
+int64_t sum_i64(const int64_t* p, size_t n);
+int64_t dot_i64(const int64_t* a, const int64_t* b, size_t n);
+
+} // namespace simd
+
+#endif // BLACKBOX_SIMD_HPP
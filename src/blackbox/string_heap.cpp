@@ -0,0 +1,167 @@
+//
+// Created by User on 2026-04-18.
+//
+
+#include "string_heap.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+namespace {
+size_t hash_of(std::string_view s) {
+    return std::hash<std::string_view>{}(s);
+}
+} // namespace
+
+StringHeap::StringHeap() {
+    index.assign(64, EMPTY);
+}
+
+int64_t StringHeap::intern(std::string_view s) {
+    // a slice of buf would be invalidated by the insert below
+    if (owns(s)) {
+        return intern(std::string(s));
+    }
+    size_t h = hash_of(s);
+    size_t pos = probe(s, h);
+    if (index[pos] != EMPTY) {
+        return make_handle(index[pos], slots[index[pos]].gen);
+    }
+    if (buf.size() + s.size() > UINT32_MAX) {
+        throw std::overflow_error("StringHeap: buffer exceeded 4GB");
+    }
+
+    uint32_t slot;
+    if (!free_slots.empty()) {
+        slot = free_slots.back();
+        free_slots.pop_back();
+    } else {
+        if (slots.size() >= EMPTY) {
+            throw std::overflow_error("StringHeap: too many strings");
+        }
+        slot = static_cast<uint32_t>(slots.size());
+        slots.emplace_back();
+    }
+    Slot& e = slots[slot];
+    e.offset = static_cast<uint32_t>(buf.size());
+    e.length = static_cast<uint32_t>(s.size());
+    e.hash = static_cast<uint32_t>(h);
+    e.live = true;
+    buf.insert(buf.end(), s.begin(), s.end());
+    index[pos] = slot;
+    live_count++;
+    if (live_count * 2 > index.size()) {
+        rehash(index.size() * 2);
+    }
+    return make_handle(slot, e.gen);
+}
+
+std::optional<int64_t> StringHeap::find(std::string_view s) const {
+    uint32_t slot = index[probe(s, hash_of(s))];
+    if (slot == EMPTY) {
+        return std::nullopt;
+    }
+    return make_handle(slot, slots[slot].gen);
+}
+
+bool StringHeap::valid(int64_t handle) const {
+    if (!is_handle(handle)) {
+        return false;
+    }
+    auto slot = static_cast<uint32_t>(handle);
+    return slot < slots.size() && slots[slot].live && slots[slot].gen == generation_of(handle);
+}
+
+std::string_view StringHeap::get(int64_t handle) const {
+    if (!valid(handle)) {
+        throw std::out_of_range("StringHeap: invalid handle");
+    }
+    return view(slots[static_cast<uint32_t>(handle)]);
+}
+
+bool StringHeap::wants_collection(size_t incoming) const {
+    return buf.size() + incoming > next_gc_bytes || live_count >= next_gc_strings;
+}
+
+size_t StringHeap::sweep() {
+    size_t before = buf.size();
+
+    // survivors in buffer order, so each one only ever moves down
+    std::vector<uint32_t> keep;
+    keep.reserve(live_count);
+    for (uint32_t slot = 0; slot < slots.size(); slot++) {
+        Slot& e = slots[slot];
+        if (!e.live) {
+            continue;
+        }
+        if (e.marked) {
+            e.marked = false;
+            keep.push_back(slot);
+        } else {
+            e.live = false;
+            e.gen++;
+            free_slots.push_back(slot);
+        }
+    }
+    std::sort(keep.begin(), keep.end(),
+              [&](uint32_t a, uint32_t b) { return slots[a].offset < slots[b].offset; });
+
+    uint32_t top = 0;
+    for (uint32_t slot : keep) {
+        Slot& e = slots[slot];
+        if (e.offset != top) {
+            std::memmove(buf.data() + top, buf.data() + e.offset, e.length);
+            e.offset = top;
+        }
+        top += e.length;
+    }
+    buf.resize(top);
+    if (buf.capacity() > 4 * MIN_GC_BYTES && buf.capacity() > 4 * buf.size()) {
+        buf.shrink_to_fit();
+    }
+
+    // hand out low slots first so the slot table stays dense
+    std::sort(free_slots.begin(), free_slots.end(), std::greater<>());
+    live_count = keep.size();
+    rehash(std::max<size_t>(64, std::bit_ceil(live_count * 2 + 1)));
+
+    // the next collection waits until the arena has doubled, so sweeping stays amortised O(1)
+    next_gc_bytes = std::max(MIN_GC_BYTES, buf.size() * 2);
+    next_gc_strings = std::max(MIN_GC_STRINGS, live_count * 2);
+    sweeps++;
+    return before - buf.size();
+}
+
+// slot holding s, or the empty slot where it would go
+size_t StringHeap::probe(std::string_view s, size_t h) const {
+    size_t mask = index.size() - 1;
+    auto tag = static_cast<uint32_t>(h);
+    for (size_t pos = h & mask;; pos = (pos + 1) & mask) {
+        uint32_t slot = index[pos];
+        if (slot == EMPTY) {
+            return pos;
+        }
+        const Slot& e = slots[slot];
+        if (e.hash == tag && e.length == s.size() && view(e) == s) {
+            return pos;
+        }
+    }
+}
+
+void StringHeap::rehash(size_t capacity) {
+    index.assign(capacity, EMPTY);
+    size_t mask = capacity - 1;
+    for (uint32_t slot = 0; slot < slots.size(); slot++) {
+        if (!slots[slot].live) {
+            continue;
+        }
+        size_t pos = slots[slot].hash & mask;
+        while (index[pos] != EMPTY) {
+            pos = (pos + 1) & mask;
+        }
+        index[pos] = slot;
+    }
+}
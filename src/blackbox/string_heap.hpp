@@ -0,0 +1,101 @@
+//
+// Created by User on 2026-04-18.
+//
+
+#ifndef BLACKBOX_STRING_HEAP_HPP
+#define BLACKBOX_STRING_HEAP_HPP
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+// strings created while the program runs (READSTR, GETARG, CHRECV, ...). program constants stay
+// in the immutable StringTable; these live in a separate arena that is collected: the VM marks
+// every value that looks like a runtime handle, sweep() frees the rest and slides the survivors
+// down so buf holds no garbage.
+//
+// a handle is TAG | generation << 32 | slot. the tag keeps ordinary integers from looking like
+// handles during the conservative scan, and the generation makes a handle to a freed slot that was
+// reused fail valid() instead of naming someone else's string. compaction moves bytes, not slots,
+// so handles survive it unchanged
+class StringHeap {
+  public:
+    static constexpr uint64_t TAG = 0x5354'5200'0000'0000; // "STR" in the top three bytes
+    static constexpr uint64_t TAG_MASK = 0xFFFF'FF00'0000'0000;
+
+    static bool is_handle(int64_t v) { return (static_cast<uint64_t>(v) & TAG_MASK) == TAG; }
+
+    StringHeap();
+
+    // identical live strings share one handle
+    int64_t intern(std::string_view s);
+
+    std::optional<int64_t> find(std::string_view s) const;
+    bool valid(int64_t handle) const;
+    // the view is invalidated by the next intern()
+    std::string_view get(int64_t handle) const;
+
+    // true when s points into the arena
+    bool owns(std::string_view s) const {
+        return !buf.empty() && s.data() >= buf.data() && s.data() < buf.data() + buf.size();
+    }
+
+    // true once enough was allocated since the last sweep that collecting is worth a root scan
+    bool wants_collection(size_t incoming) const;
+
+    // marks handle live if it names a live string; anything else is ignored
+    void mark(int64_t v) {
+        if (!is_handle(v)) {
+            return;
+        }
+        auto slot = static_cast<uint32_t>(v);
+        if (slot < slots.size() && slots[slot].live && slots[slot].gen == generation_of(v)) {
+            slots[slot].marked = true;
+        }
+    }
+
+    // frees every unmarked string, compacts the survivors and clears the marks. returns the
+    // number of bytes freed
+    size_t sweep();
+
+    size_t byte_size() const { return buf.size(); }
+    size_t count() const { return live_count; }
+    size_t collections() const { return sweeps; }
+
+  private:
+    static constexpr uint32_t EMPTY = UINT32_MAX;
+    static constexpr size_t MIN_GC_BYTES = size_t{1} << 20;
+    static constexpr size_t MIN_GC_STRINGS = 16384;
+
+    struct Slot {
+        uint32_t offset = 0;
+        uint32_t length = 0;
+        uint32_t hash = 0;
+        uint8_t gen = 0;
+        bool live = false;
+        bool marked = false;
+    };
+
+    std::vector<char> buf;
+    std::vector<Slot> slots;
+    std::vector<uint32_t> free_slots;
+    std::vector<uint32_t> index; // power-of-two sized; EMPTY or a live slot
+    size_t live_count = 0;
+    size_t sweeps = 0;
+    size_t next_gc_bytes = MIN_GC_BYTES;
+    size_t next_gc_strings = MIN_GC_STRINGS;
+
+    static uint8_t generation_of(int64_t handle) {
+        return static_cast<uint8_t>(static_cast<uint64_t>(handle) >> 32);
+    }
+    static int64_t make_handle(uint32_t slot, uint8_t gen) {
+        return static_cast<int64_t>(TAG | uint64_t{gen} << 32 | slot);
+    }
+
+    std::string_view view(const Slot& s) const { return {buf.data() + s.offset, s.length}; }
+    size_t probe(std::string_view s, size_t h) const;
+    void rehash(size_t capacity);
+};
+
+#endif // BLACKBOX_STRING_HEAP_HPP
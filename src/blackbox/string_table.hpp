@@ -6,24 +6,56 @@
 #define BLACKBOX_STRING_TABLE_HPP
 
 #include <cstdint>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <string>
 #include <string_view>
 #include <vector>
-#include <stdexcept>
 
+// interned strings. a handle is an index into entries, which record where each string lives in
+// buf and how long it is, so get() never scans for a terminator. identical strings share one
+// handle through an open-addressing hash index, so re-interning the same text does not grow buf
 class StringTable {
 public:
     StringTable() {
         buf.reserve(4096);
+        index.assign(64, EMPTY);
     }
 
-    // returns a stable handle (offset into buf)
+    // returns a stable handle; the same text always gets the same handle
     uint32_t intern(std::string_view s) {
-        if (buf.size() + s.size() + 1 > UINT32_MAX) {
+        // a slice of buf would be invalidated by the insert below
+        if (!buf.empty() && s.data() >= buf.data() && s.data() < buf.data() + buf.size()) {
+            return intern(std::string(s));
+        }
+        size_t h = hash(s);
+        size_t slot = probe(s, h);
+        if (index[slot] != EMPTY) {
+            return index[slot];
+        }
+        if (buf.size() + s.size() > UINT32_MAX || entries.size() >= EMPTY) {
             throw std::overflow_error("StringTable: buffer exceeded 4GB");
         }
-        uint32_t handle = static_cast<uint32_t>(buf.size());
+        uint32_t handle = static_cast<uint32_t>(entries.size());
+        entries.push_back(Entry{.offset = static_cast<uint32_t>(buf.size()),
+                                .length = static_cast<uint32_t>(s.size()),
+                                .hash = static_cast<uint32_t>(h)});
         buf.insert(buf.end(), s.begin(), s.end());
-        buf.push_back('\0');
+        index[slot] = handle;
+        // keep the load factor at or below 1/2
+        if (entries.size() * 2 > index.size()) {
+            rehash(index.size() * 2);
+        }
+        return handle;
+    }
+
+    // the handle of s if it was interned already
+    std::optional<uint32_t> find(std::string_view s) const {
+        uint32_t handle = index[probe(s, hash(s))];
+        if (handle == EMPTY) {
+            return std::nullopt;
+        }
         return handle;
     }
 
@@ -32,18 +64,67 @@ public:
         if (!valid(handle)) {
             throw std::out_of_range("StringTable: invalid handle");
         }
-        return std::string_view(buf.data() + handle);
+        const Entry& e = entries[handle];
+        return std::string_view(buf.data() + e.offset, e.length);
     }
 
     bool valid(uint32_t handle) const {
-        return static_cast<uint32_t>(handle) < buf.size();
+        return handle < entries.size();
     }
 
+    // bytes of string data, not counting the entry table and index
     size_t byte_size() const {
         return buf.size();
     }
 
+    size_t entry_count() const {
+        return entries.size();
+    }
+
 private:
+    static constexpr uint32_t EMPTY = UINT32_MAX;
+
+    struct Entry {
+        uint32_t offset;
+        uint32_t length;
+        uint32_t hash; // low bits of the full hash, to skip most compares and rehash without rereading
+    };
+
     std::vector<char> buf;
+    std::vector<Entry> entries;
+    std::vector<uint32_t> index; // power-of-two sized; EMPTY or a handle
+
+    static size_t hash(std::string_view s) {
+        return std::hash<std::string_view>{}(s);
+    }
+
+    // slot holding s, or the empty slot where it would go
+    size_t probe(std::string_view s, size_t h) const {
+        size_t mask = index.size() - 1;
+        auto tag = static_cast<uint32_t>(h);
+        for (size_t slot = h & mask;; slot = (slot + 1) & mask) {
+            uint32_t handle = index[slot];
+            if (handle == EMPTY) {
+                return slot;
+            }
+            const Entry& e = entries[handle];
+            if (e.hash == tag && e.length == s.size() &&
+                std::string_view(buf.data() + e.offset, e.length) == s) {
+                return slot;
+            }
+        }
+    }
+
+    void rehash(size_t capacity) {
+        index.assign(capacity, EMPTY);
+        size_t mask = capacity - 1;
+        for (uint32_t handle = 0; handle < entries.size(); handle++) {
+            size_t slot = entries[handle].hash & mask;
+            while (index[slot] != EMPTY) {
+                slot = (slot + 1) & mask;
+            }
+            index[slot] = handle;
+        }
+    }
 };
 #endif //BLACKBOX_STRING_TABLE_HPP
@@ -0,0 +1,115 @@
+//
+// Created by User on 2026-04-18.
+//
+
+#include "terminal.hpp"
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <mutex>
+
+#ifdef _WIN32
+#include <conio.h>
+#else
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+namespace terminal {
+namespace {
+std::once_flag session_flag;
+
+#ifndef _WIN32
+termios saved{};
+termios raw{};
+std::atomic<bool> raw_active{false};
+bool is_tty = false;
+
+constexpr int FATAL_SIGNALS[] = {SIGINT, SIGTERM, SIGHUP, SIGQUIT};
+
+void on_fatal_signal(int sig) {
+    restore();
+    std::signal(sig, SIG_DFL);
+    std::raise(sig);
+}
+
+bool fd_ready(int timeout_ms) {
+    pollfd pfd{.fd = STDIN_FILENO, .events = POLLIN, .revents = 0};
+    return poll(&pfd, 1, timeout_ms) != 0;
+}
+#endif
+
+void start_session() {
+#ifndef _WIN32
+    if (tcgetattr(STDIN_FILENO, &saved) != 0) {
+        return; // not a terminal: poll_key polls before reading
+    }
+    is_tty = true;
+    raw = saved;
+    raw.c_lflag &= ~static_cast<tcflag_t>(ICANON | ECHO);
+    // VMIN=0/VTIME=0 makes read() return at once, so the read itself is the zero-timeout poll
+    raw.c_cc[VMIN] = 0;
+    raw.c_cc[VTIME] = 0;
+    if (tcsetattr(STDIN_FILENO, TCSANOW, &raw) != 0) {
+        is_tty = false;
+        return;
+    }
+    raw_active = true;
+    std::atexit(restore);
+    for (int sig : FATAL_SIGNALS) {
+        std::signal(sig, on_fatal_signal);
+    }
+#endif
+}
+} // namespace
+
+int poll_key() {
+    std::call_once(session_flag, start_session);
+#ifdef _WIN32
+    return _kbhit() ? _getch() : -1;
+#else
+    if (!(is_tty && raw_active) && !fd_ready(0)) {
+        return -1;
+    }
+    unsigned char ch;
+    return read(STDIN_FILENO, &ch, 1) == 1 ? ch : -1;
+#endif
+}
+
+bool stdin_ready(int timeout_ms) {
+#ifdef _WIN32
+    (void) timeout_ms;
+    return true;
+#else
+    return fd_ready(timeout_ms);
+#endif
+}
+
+void restore() {
+#ifndef _WIN32
+    if (raw_active.exchange(false)) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+    }
+#endif
+}
+
+LineMode::LineMode() {
+#ifndef _WIN32
+    if (raw_active.exchange(false)) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+        suspended = true;
+    }
+#endif
+}
+
+LineMode::~LineMode() {
+#ifndef _WIN32
+    if (suspended) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+        raw_active = true;
+    }
+#endif
+}
+
+} // namespace terminal
@@ -0,0 +1,38 @@
+//
+// Created by User on 2026-04-18.
+//
+
+#ifndef BLACKBOX_TERMINAL_HPP
+#define BLACKBOX_TERMINAL_HPP
+
+// process-wide keyboard session shared by every VM. the first GETKEY puts the terminal into
+// non-canonical, no-echo mode; it stays there until exit, when an atexit hook or a fatal-signal
+// handler restores the original settings
+namespace terminal {
+
+// next pending key read straight from fd 0, or -1, without blocking. one syscall per call on a
+// terminal; callers drain their own stdin buffer first
+int poll_key();
+
+// true when fd 0 has data within timeout_ms (0 = just check); always true on Windows
+bool stdin_ready(int timeout_ms);
+
+// puts the terminal back the way it was; safe to call repeatedly and from signal handlers
+void restore();
+
+// line-oriented reads (READ, READSTR, ...) need canonical mode with echo; this suspends the raw
+// session for the lifetime of the guard and is free when no session is active
+class LineMode {
+  public:
+    LineMode();
+    ~LineMode();
+    LineMode(const LineMode&) = delete;
+    LineMode& operator=(const LineMode&) = delete;
+
+  private:
+    bool suspended = false;
+};
+
+} // namespace terminal
+
+#endif // BLACKBOX_TERMINAL_HPP
@@ -4,9 +4,19 @@
 
 #include "vm.hpp"
 #include "fault.hpp"
+#include "terminal.hpp"
+#include <algorithm>
+#include <csignal>
 #include <format>
 #include <iostream>
 #include <print>
+#include <thread>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 const std::array<VM::Handler, 256> VM::dispatch_table = [] {
     std::array<VM::Handler, 256> t{};
@@ -20,6 +30,11 @@ const std::array<VM::Handler, 256> VM::dispatch_table = [] {
     t[opcode_to_byte(Opcode::MOD)] = &VM::op_mod;
     t[opcode_to_byte(Opcode::INC)] = &VM::op_inc;
     t[opcode_to_byte(Opcode::DEC)] = &VM::op_dec;
+    t[opcode_to_byte(Opcode::ADD3)] = &VM::op_add3;
+    t[opcode_to_byte(Opcode::SUB3)] = &VM::op_sub3;
+    t[opcode_to_byte(Opcode::MUL3)] = &VM::op_mul3;
+    t[opcode_to_byte(Opcode::DIV3)] = &VM::op_div3;
+    t[opcode_to_byte(Opcode::MOD3)] = &VM::op_mod3;
 
     t[opcode_to_byte(Opcode::AND)] = &VM::op_and;
     t[opcode_to_byte(Opcode::OR)] = &VM::op_or;
@@ -27,6 +42,11 @@ const std::array<VM::Handler, 256> VM::dispatch_table = [] {
     t[opcode_to_byte(Opcode::NOT)] = &VM::op_not;
     t[opcode_to_byte(Opcode::SHL)] = &VM::op_shl;
     t[opcode_to_byte(Opcode::SHR)] = &VM::op_shr;
+    t[opcode_to_byte(Opcode::AND3)] = &VM::op_and3;
+    t[opcode_to_byte(Opcode::OR3)] = &VM::op_or3;
+    t[opcode_to_byte(Opcode::XOR3)] = &VM::op_xor3;
+    t[opcode_to_byte(Opcode::SHL3)] = &VM::op_shl3;
+    t[opcode_to_byte(Opcode::SHR3)] = &VM::op_shr3;
 
     t[opcode_to_byte(Opcode::POP)] = &VM::op_pop;
     t[opcode_to_byte(Opcode::CMP)] = &VM::op_cmp;
@@ -38,20 +58,72 @@ const std::array<VM::Handler, 256> VM::dispatch_table = [] {
     t[opcode_to_byte(Opcode::JGE)] = &VM::op_jge;
     t[opcode_to_byte(Opcode::JB)] = &VM::op_jb;
     t[opcode_to_byte(Opcode::JAE)] = &VM::op_jae;
+    t[opcode_to_byte(Opcode::LOOP)] = &VM::op_loop;
     t[opcode_to_byte(Opcode::CALL)] = &VM::op_call;
     t[opcode_to_byte(Opcode::RET)] = &VM::op_ret;
     t[opcode_to_byte(Opcode::HLT)] = &VM::op_HLT;
 
+    t[opcode_to_byte(Opcode::COCREATE)] = &VM::op_cocreate;
+    t[opcode_to_byte(Opcode::YIELD)] = &VM::op_yield;
+    t[opcode_to_byte(Opcode::RESUME)] = &VM::op_resume;
+
+    t[opcode_to_byte(Opcode::CAS)] = &VM::op_cas;
+    t[opcode_to_byte(Opcode::FETCHADD)] = &VM::op_fetchadd;
+    t[opcode_to_byte(Opcode::XCHG)] = &VM::op_xchg;
+    t[opcode_to_byte(Opcode::WAIT)] = &VM::op_wait;
+    t[opcode_to_byte(Opcode::WAKE)] = &VM::op_wake;
+
+    t[opcode_to_byte(Opcode::CHSEND)] = &VM::op_chsend;
+    t[opcode_to_byte(Opcode::CHRECV)] = &VM::op_chrecv;
+    t[opcode_to_byte(Opcode::CHTRY)] = &VM::op_chtry;
+
     t[opcode_to_byte(Opcode::LOADREF)] = &VM::op_loadref;
     t[opcode_to_byte(Opcode::STOREREF)] = &VM::op_storeref;
     t[opcode_to_byte(Opcode::ALLOC)] = &VM::op_alloc;
     t[opcode_to_byte(Opcode::GROW)] = &VM::op_grow;
     t[opcode_to_byte(Opcode::RESIZE)] = &VM::op_resize;
     t[opcode_to_byte(Opcode::FREE)] = &VM::op_free;
+    t[opcode_to_byte(Opcode::HALLOC)] = &VM::op_halloc;
+    t[opcode_to_byte(Opcode::HFREE)] = &VM::op_hfree;
+    t[opcode_to_byte(Opcode::LOADB)] = &VM::op_loadb;
+    t[opcode_to_byte(Opcode::LOADW)] = &VM::op_loadw;
+    t[opcode_to_byte(Opcode::LOADD)] = &VM::op_loadd;
+    t[opcode_to_byte(Opcode::LOADSB)] = &VM::op_loadsb;
+    t[opcode_to_byte(Opcode::LOADSW)] = &VM::op_loadsw;
+    t[opcode_to_byte(Opcode::LOADSD)] = &VM::op_loadsd;
+    t[opcode_to_byte(Opcode::STOREB)] = &VM::op_storeb;
+    t[opcode_to_byte(Opcode::STOREW)] = &VM::op_storew;
+    t[opcode_to_byte(Opcode::STORED)] = &VM::op_stored;
+    t[opcode_to_byte(Opcode::HEAPFIND)] = &VM::op_heapfind;
+    t[opcode_to_byte(Opcode::MEMCPY)] = &VM::op_memcpy;
+    t[opcode_to_byte(Opcode::MEMSET)] = &VM::op_memset;
+    t[opcode_to_byte(Opcode::MEMCMP)] = &VM::op_memcmp;
+    t[opcode_to_byte(Opcode::MEMMOVE)] = &VM::op_memmove;
 
     t[opcode_to_byte(Opcode::LOADSTR)] = &VM::op_loadstr;
     t[opcode_to_byte(Opcode::PRINTSTR)] = &VM::op_printstr;
     t[opcode_to_byte(Opcode::EPRINTSTR)] = &VM::op_eprintstr;
+    t[opcode_to_byte(Opcode::STRCAT)] = &VM::op_strcat;
+    t[opcode_to_byte(Opcode::STRLEN)] = &VM::op_strlen;
+    t[opcode_to_byte(Opcode::SUBSTR)] = &VM::op_substr;
+    t[opcode_to_byte(Opcode::STRCMP)] = &VM::op_strcmp;
+    t[opcode_to_byte(Opcode::CHARAT)] = &VM::op_charat;
+    t[opcode_to_byte(Opcode::STRFROMHEAP)] = &VM::op_strfromheap;
+    t[opcode_to_byte(Opcode::STRFIND)] = &VM::op_strfind;
+    t[opcode_to_byte(Opcode::STRCHR)] = &VM::op_strchr;
+    t[opcode_to_byte(Opcode::STRSPLIT)] = &VM::op_strsplit;
+    t[opcode_to_byte(Opcode::ITOA)] = &VM::op_itoa;
+    t[opcode_to_byte(Opcode::ATOI)] = &VM::op_atoi;
+    t[opcode_to_byte(Opcode::STRFMT)] = &VM::op_strfmt;
+
+    t[opcode_to_byte(Opcode::VADD)] = &VM::op_vadd;
+    t[opcode_to_byte(Opcode::VSUB)] = &VM::op_vsub;
+    t[opcode_to_byte(Opcode::VMUL)] = &VM::op_vmul;
+    t[opcode_to_byte(Opcode::VAND)] = &VM::op_vand;
+    t[opcode_to_byte(Opcode::VMIN)] = &VM::op_vmin;
+    t[opcode_to_byte(Opcode::VMAX)] = &VM::op_vmax;
+    t[opcode_to_byte(Opcode::VSUM)] = &VM::op_vsum;
+    t[opcode_to_byte(Opcode::VDOT)] = &VM::op_vdot;
 
     t[opcode_to_byte(Opcode::WRITE)] = &VM::op_write;
     t[opcode_to_byte(Opcode::PRINT)] = &VM::op_print;
@@ -68,8 +140,16 @@ const std::array<VM::Handler, 256> VM::dispatch_table = [] {
     t[opcode_to_byte(Opcode::FREAD)] = &VM::op_fread;
 
     t[opcode_to_byte(Opcode::EXEC)] = &VM::op_exec;
+    t[opcode_to_byte(Opcode::EXECX)] = &VM::op_execx;
+    t[opcode_to_byte(Opcode::EXECBG)] = &VM::op_execbg;
+    t[opcode_to_byte(Opcode::EXECWAIT)] = &VM::op_execwait;
     t[opcode_to_byte(Opcode::SLEEP)] = &VM::op_sleep;
+    t[opcode_to_byte(Opcode::SCRINIT)] = &VM::op_scrinit;
+    t[opcode_to_byte(Opcode::SCRPUT)] = &VM::op_scrput;
+    t[opcode_to_byte(Opcode::SCRBLIT)] = &VM::op_scrblit;
+    t[opcode_to_byte(Opcode::SCRFLUSH)] = &VM::op_scrflush;
     t[opcode_to_byte(Opcode::RAND)] = &VM::op_rand;
+    t[opcode_to_byte(Opcode::RANDFILL)] = &VM::op_randfill;
     t[opcode_to_byte(Opcode::GETKEY)] = &VM::op_getkey;
     t[opcode_to_byte(Opcode::CLRSCR)] = &VM::op_clrscr;
     t[opcode_to_byte(Opcode::GETARG)] = &VM::op_getarg;
@@ -85,6 +165,8 @@ const std::array<VM::Handler, 256> VM::dispatch_table = [] {
     t[opcode_to_byte(Opcode::REGFAULT)] = &VM::op_regfault;
     t[opcode_to_byte(Opcode::FAULTRET)] = &VM::op_faultret;
     t[opcode_to_byte(Opcode::GETFAULT)] = &VM::op_getfault;
+    t[opcode_to_byte(Opcode::REFUEL)] = &VM::op_refuel;
+    t[opcode_to_byte(Opcode::GETFUEL)] = &VM::op_getfuel;
 
     t[opcode_to_byte(Opcode::BREAK)] = &VM::op_break;
     t[opcode_to_byte(Opcode::NOP)] = &VM::op_nop;
@@ -95,6 +177,13 @@ const std::array<VM::Handler, 256> VM::dispatch_table = [] {
     t[opcode_to_byte(Opcode::PUSH)] = &VM::op_push;
     t[opcode_to_byte(Opcode::FWRITE)] = &VM::op_fwrite;
     t[opcode_to_byte(Opcode::FSEEK)] = &VM::op_fseek;
+    t[opcode_to_byte(Opcode::FCOPY)] = &VM::op_fcopy;
+    t[opcode_to_byte(Opcode::FMAP)] = &VM::op_fmap;
+    t[opcode_to_byte(Opcode::FUNMAP)] = &VM::op_funmap;
+    t[opcode_to_byte(Opcode::FREADNB)] = &VM::op_freadnb;
+    t[opcode_to_byte(Opcode::FWRITENB)] = &VM::op_fwritenb;
+    t[opcode_to_byte(Opcode::POLL)] = &VM::op_poll;
+    t[opcode_to_byte(Opcode::PIPE)] = &VM::op_pipe;
 
     return t;
 }();
@@ -128,44 +217,16 @@ int64_t VM::read_operand() {
             }
             return static_cast<int64_t>(prog.data_string_handles[idx]);
         }
-        case OperandType::HeapAddr: {
-            uint32_t addr = fetch_u32();
-            {
-                if (addr >= op_stack.size()) {
-                    hard_fault(FaultType::OutOfBounds,
-                               std::format("MOV src slot {} out of bounds at pc={}", addr, pc));
-                }
-                if (cur_mode == Mode::Privileged && !op_stack_perms[addr].priv_read) {
-                    raise_fault(FaultType::PermRead,
-                                std::format("MOV read denied at slot {} pc={}", addr, pc));
-                }
-                if (cur_mode == Mode::Protected && !op_stack_perms[addr].prot_read) {
-                    raise_fault(FaultType::PermRead,
-                                std::format("MOV read denied at slot {} pc={}", addr, pc));
-                }
-            }
-            return heap_addr(addr);
-        }
-        case OperandType::HeapReg: {
-            uint32_t addr = static_cast<uint32_t>(regs[fetch_reg()]);
-            if (addr >= op_stack.size()) {
-                    hard_fault(FaultType::OutOfBounds,
-                               std::format("MOV src slot {} out of bounds at pc={}", addr, pc));
-                }
-                if (cur_mode == Mode::Privileged && !op_stack_perms[addr].priv_read) {
-                    raise_fault(FaultType::PermRead,
-                                std::format("MOV read denied at slot {} pc={}", addr, pc));
-                }
-                if (cur_mode == Mode::Protected && !op_stack_perms[addr].prot_read) {
-                    raise_fault(FaultType::PermRead,
-                                std::format("MOV read denied at slot {} pc={}", addr, pc));
-                }
-            return heap_addr(addr);
-        }
+        case OperandType::HeapAddr:
+            return heap_addr(fetch_u32(), false);
+        case OperandType::HeapReg:
+            return heap_addr(static_cast<uint32_t>(regs[fetch_reg()]), false);
         case OperandType::VarReg: {
             uint32_t slot = static_cast<uint32_t>(regs[fetch_reg()]);
             return var(slot);
         }
+        case OperandType::HeapIndexed:
+            return heap_addr(fetch_indexed_addr(), false);
         default:
             hard_fault(FaultType::OutOfBounds, std::format("unknown operand type 0x{:02X} at pc={}",
                                                            static_cast<uint8_t>(type), pc));
@@ -173,23 +234,36 @@ int64_t VM::read_operand() {
 }
 
 VM::VM(Program program, int argc, char** argv)
-    : prog(std::move(program)), host_argc(argc), host_argv(argv) {
+    : prog(std::move(program)), rng(blackbox::tools::get_true_random()), host_argc(argc),
+      host_argv(argv) {
     // set up global memory segment
     global_end = prog.bss_count;
-    mem.resize(global_end, 0);
-    mem_top = global_end;
+    globals.resize(global_end, 0);
+
+    // main program runs as coroutine 0
+    coroutines.emplace_back();
+    coroutines[0].state = Coroutine::State::Running;
 
     // stdio fds
     fds[0].kind = FD::Kind::StdIn;
     fds[1].kind = FD::Kind::StdOut;
     fds[2].kind = FD::Kind::StdErr;
+    reactor.add(0, Reactor::READABLE, STDIN_TAG);
 
     pc = prog.entry_point;
 }
 
 int VM::run() {
-    while (step()) {
+    // a pipeline peer blocks in CHSEND/CHRECV until these close, so close them on every way out,
+    // not just after a fault or HLT
+    try {
+        while (step()) {
+        }
+    } catch (...) {
+        close_channels();
+        throw;
     }
+    close_channels();
     return exit_code;
 }
 
@@ -246,6 +320,30 @@ size_t VM::fetch_reg() {
     return static_cast<size_t>(r);
 }
 
+// [base + index*scale + disp]. either register may be absent; the sum wraps like ADD and MUL do,
+// so a negative address comes back huge and fails the caller's bounds check
+uint64_t VM::fetch_indexed_addr() {
+    size_t at = pc;
+    uint8_t base = fetch_u8();
+    uint8_t index = fetch_u8();
+    uint8_t scale = fetch_u8();
+    int32_t disp = fetch_i32();
+    for (uint8_t r : {base, index}) {
+        if (r != NO_REGISTER && r >= REGISTERS) {
+            hard_fault(FaultType::OutOfBounds,
+                       std::format("invalid register R{:02} at pc={}", r, at));
+        }
+    }
+    auto addr = static_cast<uint64_t>(int64_t{disp});
+    if (base != NO_REGISTER) {
+        addr += static_cast<uint64_t>(regs[base]);
+    }
+    if (index != NO_REGISTER) {
+        addr += static_cast<uint64_t>(regs[index]) * scale;
+    }
+    return addr;
+}
+
 // memory helpers 7
 int64_t& VM::var(uint32_t slot) {
     if (call_stack.empty()) {
@@ -267,17 +365,19 @@ int64_t& VM::global_var(uint32_t slot) {
                    std::format("global slot {} out of bounds (global_end={}) at pc={}", slot,
                                global_end, pc));
     }
-    return mem[slot];
+    return globals[slot];
 }
 
 // frames
 void VM::push_frame(size_t frame_size, size_t ret_pc) {
+    check_frame_quota(frame_size, "CALL");
     call_stack.push_back(Frame{.ret_pc = ret_pc, .frame_base = mem_top});
     size_t new_top = mem_top + frame_size;
     if (new_top > mem.size()) {
         mem.resize(new_top, 0);
     }
     mem_top = new_top;
+    frame_slots_used += frame_size;
 }
 
 void VM::pop_frame() {
@@ -286,12 +386,14 @@ void VM::pop_frame() {
     }
     Frame f = call_stack.back();
     call_stack.pop_back();
+    frame_slots_used -= mem_top - f.frame_base;
     mem_top = f.frame_base;
     pc = f.ret_pc;
 }
 
 // operand stack
 void VM::operand_push(int64_t value) {
+    check_heap_quota(op_stack.size() + 1, "PUSH");
     op_stack.push_back(value);
     if (op_stack.size() > op_stack_perms.size()) {
         op_stack_perms.push_back(SlotPermission{1, 1, 1, 1});
@@ -304,9 +406,204 @@ int64_t VM::operand_pop() {
     }
     int64_t v = op_stack.back();
     op_stack.pop_back();
+    // a later PUSH must not inherit the popped slot's permissions, e.g. a dropped FMAP window's
+    if (op_stack_perms.size() > op_stack.size()) {
+        op_stack_perms.resize(op_stack.size());
+    }
+    heap_alloc.truncate(op_stack.size());
     return v;
 }
 
+// coroutines
+void VM::save_context(Coroutine& co) {
+    co.pc = pc;
+    co.regs = regs;
+    co.ZF = ZF;
+    co.CF = CF;
+    co.SF = SF;
+    co.OF = OF;
+    co.AF = AF;
+    co.PF = PF;
+    std::swap(co.call_stack, call_stack);
+    std::swap(co.mem, mem);
+    co.mem_top = mem_top;
+}
+
+void VM::load_context(Coroutine& co) {
+    pc = co.pc;
+    regs = co.regs;
+    ZF = co.ZF;
+    CF = co.CF;
+    SF = co.SF;
+    OF = co.OF;
+    AF = co.AF;
+    PF = co.PF;
+    std::swap(co.call_stack, call_stack);
+    std::swap(co.mem, mem);
+    mem_top = co.mem_top;
+}
+
+// a switch lands on an arbitrary pc like a backward jump, so it costs fuel. the charge comes
+// after the switch is complete: an out-of-fuel fault then belongs to the coroutine switched to and
+// FAULTRET resumes it
+void VM::switch_to(size_t id) {
+    bool switched = id != cur_co;
+    if (switched) {
+        save_context(coroutines[cur_co]);
+        cur_co = id;
+        load_context(coroutines[id]);
+    }
+    coroutines[id].state = Coroutine::State::Running;
+    if (switched) {
+        charge_fuel();
+    }
+}
+
+void VM::wake_timers() {
+    auto now = std::chrono::steady_clock::now();
+    while (!timers.empty()) {
+        const Timer& t = timers.top();
+        Coroutine& co = coroutines[t.id];
+        bool stale = co.state != Coroutine::State::Sleeping || co.wake_seq != t.seq;
+        if (!stale && t.wake > now) {
+            break;
+        }
+        if (!stale) {
+            co.state = Coroutine::State::Ready;
+            run_queue.push_back(t.id);
+        }
+        timers.pop();
+    }
+}
+
+// switch to the next ready coroutine, sleeping until a timer fires if none is ready
+bool VM::schedule() {
+    wake_timers();
+    while (run_queue.empty()) {
+        if (timers.empty()) {
+            return false;
+        }
+        std::this_thread::sleep_until(timers.top().wake);
+        wake_timers();
+    }
+    size_t next = run_queue.front();
+    run_queue.pop_front();
+    switch_to(next);
+    return true;
+}
+
+void VM::yield_current() {
+    coroutines[cur_co].state = Coroutine::State::Ready;
+    run_queue.push_back(cur_co);
+    schedule();
+}
+
+void VM::sleep_current(uint64_t ms) {
+    Coroutine& co = coroutines[cur_co];
+    co.state = Coroutine::State::Sleeping;
+    ++co.wake_seq;
+    timers.push(Timer{.wake = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms),
+                      .id = cur_co,
+                      .seq = co.wake_seq});
+    schedule();
+}
+
+void VM::finish_coroutine() {
+    coroutines[cur_co].state = Coroutine::State::Free;
+    free_coroutines.push_back(cur_co);
+    --live_coroutines;
+    call_stack.clear();
+    mem.clear();
+    frame_slots_used -= mem_top;
+    mem_top = 0;
+    if (!schedule()) {
+        hard_fault(FaultType::Deadlock,
+                   std::format("every remaining coroutine is waiting at pc={}", pc));
+    }
+}
+
+void VM::cancel_wait(size_t id) {
+    auto it = waiters.find(coroutines[id].wait_addr);
+    if (it == waiters.end()) {
+        return;
+    }
+    std::erase(it->second, id);
+    if (it->second.empty()) {
+        waiters.erase(it);
+    }
+}
+
+// rewind to the current instruction and let other coroutines run while stdin has no data
+bool VM::yield_if_blocked_on_stdin() {
+    if (live_coroutines <= 1) {
+        return false;
+    }
+    wake_timers();
+    int timeout_ms = 0;
+    if (run_queue.empty()) {
+        if (timers.empty()) {
+            return false;
+        }
+        auto wait = std::chrono::ceil<std::chrono::milliseconds>(timers.top().wake -
+                                                                 std::chrono::steady_clock::now());
+        timeout_ms = static_cast<int>(std::max<int64_t>(wait.count(), 0));
+    }
+    if (stdin_buf.buffered() || terminal::stdin_ready(timeout_ms)) {
+        return false;
+    }
+    pc = instr_pc;
+    yield_current();
+    return true;
+}
+
+// like yield_if_blocked_on_stdin, for a channel or child process that is not ready yet
+bool VM::yield_to_retry() {
+    if (live_coroutines <= 1) {
+        return false;
+    }
+    wake_timers();
+    if (run_queue.empty()) {
+        if (timers.empty()) {
+            return false;
+        }
+        // only sleepers left: check the channel again shortly instead of blocking past their timers
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    pc = instr_pc;
+    yield_current();
+    return true;
+}
+
+// channels
+void VM::attach_channel(size_t id, std::shared_ptr<Channel> channel, bool sender) {
+    channels.at(id) = ChannelPort{.channel = std::move(channel), .sender = sender};
+}
+
+Channel& VM::channel_port(uint8_t id, bool sender, std::string_view opname) {
+    if (id >= MAX_CHANNELS || !channels[id].channel) {
+        hard_fault(FaultType::OutOfBounds,
+                   std::format("{} channel {} is not connected at pc={}", opname, id, pc));
+    }
+    if (channels[id].sender != sender) {
+        hard_fault(FaultType::IllegalOp,
+                   std::format("{} wrong direction for channel {} at pc={}", opname, id, pc));
+    }
+    return *channels[id].channel;
+}
+
+void VM::close_channels() {
+    for (auto& port : channels) {
+        if (!port.channel) {
+            continue;
+        }
+        if (port.sender) {
+            port.channel->close_send();
+        } else {
+            port.channel->close_recv();
+        }
+    }
+}
+
 // fault handling
 void VM::hard_fault(FaultType type, std::string_view message) {
     throw VMFault{type, std::string(message), pc};
@@ -323,11 +620,127 @@ void VM::require_privileged(std::string_view opname) {
     }
 }
 
+// fuel
+void VM::set_fuel(uint64_t units) {
+    fuel = units;
+    fuel_metered = true;
+}
+
+// fault handlers run unmetered so a supervisor can always refill or halt
+void VM::charge_fuel() {
+    if (!fuel_metered || current_fault != FaultType::Count) {
+        return;
+    }
+    if (fuel == 0) {
+        raise_fault(FaultType::FuelExhausted, std::format("out of fuel at pc={}", instr_pc));
+        return;
+    }
+    --fuel;
+}
+
+// quotas
+void VM::check_heap_quota(size_t new_size, std::string_view opname) {
+    if (limits.heap_slots != 0 && new_size > limits.heap_slots) {
+        raise_fault(FaultType::QuotaExceeded,
+                    std::format("{} would grow heap to {} slots (limit {}) at pc={}", opname,
+                                new_size, limits.heap_slots, pc));
+    }
+}
+
+void VM::check_frame_quota(size_t frame_size, std::string_view opname) {
+    if (limits.frame_slots != 0 && frame_slots_used + frame_size > limits.frame_slots) {
+        raise_fault(FaultType::QuotaExceeded,
+                    std::format("{} would use {} frame slots (limit {}) at pc={}", opname,
+                                frame_slots_used + frame_size, limits.frame_slots, pc));
+    }
+}
+
+// every runtime string goes through here so the string quota sees it and the collector can free it
+int64_t VM::intern_string(std::string_view s) {
+    if (auto handle = prog.strings.find(s)) {
+        return *handle;
+    }
+    if (auto handle = runtime_strings.find(s)) {
+        return *handle;
+    }
+    // a collection compacts the arena under a view into it
+    if (runtime_strings.owns(s)) {
+        return intern_string(std::string(s));
+    }
+
+    bool collected = false;
+    if (runtime_strings.wants_collection(s.size())) {
+        collect_strings();
+        collected = true;
+    }
+    size_t new_size = prog.strings.byte_size() + runtime_strings.byte_size() + s.size();
+    if (limits.string_bytes != 0 && new_size > limits.string_bytes && !collected) {
+        collect_strings();
+        new_size = prog.strings.byte_size() + runtime_strings.byte_size() + s.size();
+    }
+    if (runtime_strings.byte_size() + s.size() > UINT32_MAX ||
+        (limits.string_bytes != 0 && new_size > limits.string_bytes)) {
+        raise_fault(FaultType::QuotaExceeded,
+                    std::format("string table would grow to {} bytes (limit {}) at pc={}", new_size,
+                                limits.string_bytes != 0 ? limits.string_bytes : UINT32_MAX, pc));
+    }
+    return runtime_strings.intern(s);
+}
+
+// program constants are table indices; runtime strings carry the StringHeap tag
+std::string_view VM::string_at(int64_t handle, std::string_view opname) {
+    if (StringHeap::is_handle(handle)) {
+        if (runtime_strings.valid(handle)) {
+            return runtime_strings.get(handle);
+        }
+    } else if (handle >= 0 && handle <= UINT32_MAX &&
+               prog.strings.valid(static_cast<uint32_t>(handle))) {
+        return prog.strings.get(static_cast<uint32_t>(handle));
+    }
+    hard_fault(FaultType::OutOfBounds,
+               std::format("{} invalid string handle {:#x} at pc={}", opname, handle, pc));
+}
+
+// conservative mark: every slot a program can keep a value in is a root, and any value carrying
+// the runtime tag keeps its string alive. mapped file windows hold file bytes, not handles
+void VM::collect_strings() {
+    auto mark = [&](std::span<const int64_t> values) {
+        for (int64_t v : values) {
+            runtime_strings.mark(v);
+        }
+    };
+    mark(regs);
+    mark(globals);
+    mark(std::span(mem.data(), mem_top));
+    for (size_t id = 0; id < coroutines.size(); id++) {
+        const Coroutine& co = coroutines[id];
+        if (id == cur_co || co.state == Coroutine::State::Free) {
+            continue;
+        }
+        mark(co.regs);
+        mark(std::span(co.mem.data(), co.mem_top));
+    }
+    op_stack.for_each_owned(
+        [&](size_t first, size_t n) { mark(std::span(op_stack.data() + first, n)); });
+    runtime_strings.sweep();
+}
+
+VM::MemoryStats VM::memory_stats() const {
+    return MemoryStats{
+        .heap_slots = op_stack.size(),
+        .heap_bytes = op_stack.size() * (sizeof(int64_t) + sizeof(SlotPermission)),
+        .frame_slots = frame_slots_used,
+        .frame_bytes = frame_slots_used * sizeof(int64_t),
+        .string_count = prog.strings.entry_count() + runtime_strings.count(),
+        .string_bytes = prog.strings.byte_size() + runtime_strings.byte_size(),
+        .string_collections = runtime_strings.collections(),
+        .allocator = heap_alloc.stats(),
+    };
+}
+
 // fd
 std::istream* VM::FD::reader() {
     switch (kind) {
-        case Kind::StdIn:
-            return &std::cin;
         case Kind::File:
             return file.get();
         default:
@@ -348,6 +761,119 @@ std::ostream* VM::FD::writer() {
     }
 }
 
+void VM::FD::close() {
+    if (os_fd >= 0) {
+#ifdef _WIN32
+        _close(os_fd);
+#else
+        ::close(os_fd);
+#endif
+    }
+    kind = Kind::Closed;
+    file.reset();
+    path.clear();
+    in.reset();
+    os_fd = -1;
+}
+
+VM::FD& VM::fetch_fd(std::string_view opname) {
+    uint8_t fd = fetch_u8();
+    if (fd >= FILE_DESCRIPTORS) {
+        hard_fault(FaultType::OutOfBounds, std::format("{} invalid fd {} at pc={}", opname, fd, pc));
+    }
+    return fds[fd];
+}
+
+void VM::close_fd(uint8_t fd) {
+    if (fds[fd].os_fd >= 0) {
+        reactor.remove(fds[fd].os_fd);
+    }
+    fds[fd].close();
+}
+
+void VM::attach_os_fd(uint8_t fd, FD::Kind kind, int os_fd, bool read_end) {
+    close_fd(fd);
+    fds[fd].kind = kind;
+    fds[fd].os_fd = os_fd;
+    if (read_end) {
+        fds[fd].in = std::make_unique<InputBuffer>(os_fd, 4096);
+    } else {
+#ifndef _WIN32
+        // a write to a pipe or FIFO whose reader is gone must fault, not kill the process
+        std::signal(SIGPIPE, SIG_IGN);
+#endif
+    }
+    reactor.add(os_fd, read_end ? Reactor::READABLE : Reactor::WRITABLE, fd);
+}
+
+// one byte from a readable fd: the byte, -1 at end of input, or WOULD_BLOCK when nonblocking is
+// set and a pipe or FIFO has nothing yet. blocking reads of non-blocking fds wait for data
+int VM::read_byte(FD& f, bool nonblocking, std::string_view opname) {
+    if (f.kind == FD::Kind::StdIn) {
+        if (nonblocking && !stdin_buf.buffered() && !terminal::stdin_ready(0)) {
+            return WOULD_BLOCK;
+        }
+        terminal::LineMode line_mode;
+        return stdin_buf.get();
+    }
+    if (f.in) {
+        for (;;) {
+            int c = f.in->get();
+            if (c != InputBuffer::END || !f.in->would_block()) {
+                return c;
+            }
+            if (nonblocking) {
+                return WOULD_BLOCK;
+            }
+            Reactor::wait_one(f.os_fd, Reactor::READABLE, -1);
+        }
+    }
+    std::istream* in = f.reader();
+    if (!in) {
+        hard_fault(FaultType::OutOfBounds,
+                   std::format("{} fd {} not open for reading at pc={}", opname, &f - fds.data(), pc));
+    }
+    int c = in->get();
+    return c == EOF ? -1 : c;
+}
+
+// false only when nonblocking is set and a pipe or FIFO is full
+bool VM::write_byte(FD& f, uint8_t byte, bool nonblocking, std::string_view opname) {
+    if (f.os_fd >= 0 && !f.in) {
+        for (;;) {
+#ifdef _WIN32
+            int n = _write(f.os_fd, &byte, 1);
+#else
+            ssize_t n = ::write(f.os_fd, &byte, 1);
+#endif
+            if (n == 1) {
+                return true;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                if (nonblocking) {
+                    return false;
+                }
+                Reactor::wait_one(f.os_fd, Reactor::WRITABLE, -1);
+                continue;
+            }
+            hard_fault(FaultType::OutOfBounds,
+                       std::format("{} fd {} write failed ({}) at pc={}", opname, &f - fds.data(),
+                                   errno == EPIPE ? "no reader" : "error", pc));
+        }
+    }
+    std::ostream* out = f.writer();
+    if (!out) {
+        hard_fault(FaultType::OutOfBounds,
+                   std::format("{} fd {} not open for writing at pc={}", opname, &f - fds.data(), pc));
+    }
+    out->put(static_cast<char>(byte));
+    out->flush();
+    return true;
+}
+
 void VM::op_unknown() {
     hard_fault(FaultType::OutOfBounds,
                std::format("unknown opcode 0x{:02X} at pc={}", prog.code[pc - 1], pc - 1));
@@ -358,6 +884,7 @@ bool VM::step() {
         return false;
     }
 
+    instr_pc = pc;
     uint8_t byte = prog.code[pc++];
     try {
         (this->*dispatch_table[byte])();
@@ -377,11 +904,22 @@ bool VM::step() {
     }
     return !HLTed;
 }
-int64_t& VM::heap_addr(uint32_t addr) {
+// every single-slot heap operand form goes through here, so the bounds and permission checks
+// are the same whichever way the address was encoded
+int64_t& VM::heap_addr(uint64_t addr, bool write) {
     if (addr >= op_stack.size()) {
         hard_fault(FaultType::OutOfBounds,
-                   std::format("heap address {} out of bounds (op_stack.size()={}) at pc={}", addr,
-                               op_stack.size(), pc));
+                   std::format("{} slot {} out of bounds at pc={}", write ? "heap" : "MOV src",
+                               static_cast<int64_t>(addr), pc));
+    }
+    const SlotPermission& p = op_stack_perms[addr];
+    bool priv = cur_mode == Mode::Privileged;
+    if (write && !(priv ? p.priv_write : p.prot_write)) {
+        raise_fault(FaultType::PermWrite, std::format("write denied at slot {} pc={}", addr, pc));
+    }
+    if (!write && !(priv ? p.priv_read : p.prot_read)) {
+        raise_fault(FaultType::PermRead,
+                    std::format("MOV read denied at slot {} pc={}", addr, pc));
     }
     return op_stack[addr];
 }
@@ -395,41 +933,83 @@ int64_t& VM::fetch_writable() {
             return global_var(fetch_u32());
         case OperandType::Var:
             return var(fetch_u32());
-        case OperandType::HeapAddr: {
-            uint32_t addr = fetch_u32();
-            if (addr >= op_stack.size()) {
-                hard_fault(FaultType::OutOfBounds,
-                           std::format("heap slot {} out of bounds at pc={}", addr, pc));
-            }
-            if (cur_mode == Mode::Privileged && !op_stack_perms[addr].priv_write) {
-                raise_fault(FaultType::PermWrite,
-                            std::format("write denied at slot {} pc={}", addr, pc));
-            }
-            if (cur_mode == Mode::Protected && !op_stack_perms[addr].prot_write) {
-                raise_fault(FaultType::PermWrite,
-                            std::format("write denied at slot {} pc={}", addr, pc));
-            }
-            return heap_addr(addr);
-        }
-        case OperandType::HeapReg: {
-            uint32_t addr = static_cast<uint32_t>(regs[fetch_reg()]);
-            if (addr >= op_stack.size()) {
-                hard_fault(FaultType::OutOfBounds,
-                           std::format("heap slot {} out of bounds at pc={}", addr, pc));
-            }
-            if (cur_mode == Mode::Privileged && !op_stack_perms[addr].priv_write) {
-                raise_fault(FaultType::PermWrite,
-                            std::format("write denied at slot {} pc={}", addr, pc));
-            }
-            if (cur_mode == Mode::Protected && !op_stack_perms[addr].prot_write) {
-                raise_fault(FaultType::PermWrite,
-                            std::format("write denied at slot {} pc={}", addr, pc));
-            }
-            return heap_addr(addr);
-        }
+        case OperandType::HeapAddr:
+            return heap_addr(fetch_u32(), true);
+        case OperandType::HeapReg:
+            return heap_addr(static_cast<uint32_t>(regs[fetch_reg()]), true);
+        case OperandType::HeapIndexed:
+            return heap_addr(fetch_indexed_addr(), true);
         default:
             hard_fault(FaultType::OutOfBounds,
                        std::format("non-writable dst operand type 0x{:02X} at pc={}",
                                    static_cast<uint8_t>(type), pc));
     }
 }
+
+// heap operand of a bulk instruction; the caller checks the range with check_heap_range
+size_t VM::fetch_heap_base(std::string_view opname) {
+    auto type = static_cast<OperandType>(fetch_u8());
+    switch (type) {
+        case OperandType::HeapAddr:
+            return fetch_u32();
+        case OperandType::HeapReg:
+            return static_cast<uint32_t>(regs[fetch_reg()]);
+        case OperandType::HeapIndexed:
+            // anything past the heap, negative addresses included, fails check_heap_range
+            return static_cast<size_t>(fetch_indexed_addr());
+        default:
+            hard_fault(FaultType::IllegalOp,
+                       std::format("{} requires a heap address operand at pc={}", opname, pc));
+    }
+}
+
+void VM::check_heap_range(size_t base, size_t count, bool write, std::string_view opname) {
+    if (base > op_stack.size() || count > op_stack.size() - base) {
+        hard_fault(FaultType::OutOfBounds,
+                   std::format("{} range [{}, {}) out of bounds (op_stack.size()={}) at pc={}",
+                               opname, base, base + count, op_stack.size(), pc));
+    }
+    // only the part of the range that overlaps restricted slots needs looking at
+    size_t first = std::max(base, restricted_lo);
+    size_t end = std::min(base + count, restricted_hi);
+    bool priv = cur_mode == Mode::Privileged;
+    for (size_t i = first; i < end; i++) {
+        const SlotPermission& p = op_stack_perms[i];
+        if (write && !(priv ? p.priv_write : p.prot_write)) {
+            raise_fault(FaultType::PermWrite,
+                        std::format("{} write denied at slot {} pc={}", opname, i, pc));
+        }
+        if (!write && !(priv ? p.priv_read : p.prot_read)) {
+            raise_fault(FaultType::PermRead,
+                        std::format("{} read denied at slot {} pc={}", opname, i, pc));
+        }
+    }
+}
+
+void VM::note_restricted(size_t first, size_t end) {
+    if (first < end) {
+        restricted_lo = std::min(restricted_lo, first);
+        restricted_hi = std::max(restricted_hi, end);
+    }
+}
+
+// atomics only operate on heap slots and need both read and write permission there
+int64_t& VM::fetch_atomic_slot(std::string_view opname) {
+    auto type = static_cast<OperandType>(pc < prog.code.size() ? prog.code[pc] : 0xFF);
+    if (type != OperandType::HeapAddr && type != OperandType::HeapReg &&
+        type != OperandType::HeapIndexed) {
+        hard_fault(FaultType::IllegalOp,
+                   std::format("{} requires a heap address operand at pc={}", opname, pc));
+    }
+    int64_t& slot = fetch_writable();
+    size_t addr = static_cast<size_t>(&slot - op_stack.data());
+    if (cur_mode == Mode::Privileged && !op_stack_perms[addr].priv_read) {
+        raise_fault(FaultType::PermRead,
+                    std::format("{} read denied at slot {} pc={}", opname, addr, pc));
+    }
+    if (cur_mode == Mode::Protected && !op_stack_perms[addr].prot_read) {
+        raise_fault(FaultType::PermRead,
+                    std::format("{} read denied at slot {} pc={}", opname, addr, pc));
+    }
+    return slot;
+}
@@ -1,23 +1,70 @@
 #pragma once
 
 #include "../define.hpp"
+#include "../utils/random_utils.hpp"
+#include "allocator.hpp"
+#include "channel.hpp"
 #include "fault.hpp"
+#include "heap.hpp"
+#include "input_buffer.hpp"
 #include "program.hpp"
+#include "reactor.hpp"
+#include "screen.hpp"
+#include "simd.hpp"
+#include "string_heap.hpp"
 #include <array>
+#include <chrono>
 #include <cstdint>
+#include <deque>
 #include <filesystem>
 #include <fstream>
 #include <memory>
+#include <queue>
 #include <span>
+#include <string>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 
 class VM {
   public:
+    // per-VM growth limits; 0 means unlimited
+    struct Limits {
+        size_t heap_slots = 0;
+        size_t frame_slots = 0; // summed over every coroutine
+        size_t string_bytes = 0;
+    };
+
+    struct MemoryStats {
+        size_t heap_slots = 0;
+        size_t heap_bytes = 0;
+        size_t frame_slots = 0;
+        size_t frame_bytes = 0;
+        size_t string_count = 0;
+        size_t string_bytes = 0;
+        size_t string_collections = 0;
+        SlotAllocator::Stats allocator;
+    };
+
     explicit VM(Program program, int argc, char** argv);
     int run();
     bool step();
 
+    // fuel is charged per taken backward jump and per CALL; unmetered until set
+    void set_fuel(uint64_t units);
+    uint64_t get_fuel() const { return fuel; }
+
+    // RAND is seeded from the OS once; a fixed seed makes runs reproducible
+    void set_seed(uint64_t seed) { rng.reseed(seed); }
+
+    // growth past a limit raises QUOTA_EXCEEDED
+    void set_limits(const Limits& l) { limits = l; }
+    const Limits& get_limits() const { return limits; }
+    MemoryStats memory_stats() const;
+
+    // host wiring; a VM closes its end of every attached channel when it halts
+    void attach_channel(size_t id, std::shared_ptr<Channel> channel, bool sender);
+
     // debugger
     size_t get_pc() const { return pc; }
     int64_t get_reg(size_t r) const { return regs[r]; }
@@ -41,9 +88,12 @@ class VM {
 
     uint8_t ZF = 0, CF = 0, SF = 0, OF = 0, AF = 0, PF = 0;
 
+    std::vector<int64_t> globals;
+    size_t global_end = 0;
+
+    // frame memory of the running coroutine
     std::vector<int64_t> mem;
     size_t mem_top = 0;
-    size_t global_end = 0;
 
     struct Frame {
         size_t ret_pc;
@@ -51,22 +101,97 @@ class VM {
     };
     std::vector<Frame> call_stack;
 
-    std::vector<int64_t> op_stack;
+    // coroutines; the running one lives in pc/regs/flags/call_stack/mem
+    struct Coroutine {
+        enum class State : uint8_t { Free, Ready, Running, Sleeping, Waiting };
+        State state = State::Free;
+        size_t pc = 0;
+        std::array<int64_t, REGISTERS> regs{};
+        uint8_t ZF = 0, CF = 0, SF = 0, OF = 0, AF = 0, PF = 0;
+        std::vector<Frame> call_stack;
+        std::vector<int64_t> mem;
+        size_t mem_top = 0;
+        uint64_t wake_seq = 0; // bumped to invalidate pending timers
+        uint32_t wait_addr = 0;
+    };
+    struct Timer {
+        std::chrono::steady_clock::time_point wake;
+        size_t id;
+        uint64_t seq;
+
+        bool operator>(const Timer& other) const { return wake > other.wake; }
+    };
+    std::vector<Coroutine> coroutines;
+    std::vector<size_t> free_coroutines;
+    std::deque<size_t> run_queue;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<>> timers;
+    std::unordered_map<uint32_t, std::deque<size_t>> waiters;
+    size_t cur_co = 0;
+    size_t live_coroutines = 1;
+    size_t instr_pc = 0;
+
+    Heap op_stack;
+    // blocks handed out by HALLOC; ALLOC/GROW/RESIZE/FREE still move the top directly
+    SlotAllocator heap_alloc;
+
+    // strings made at run time; constants stay in prog.strings
+    StringHeap runtime_strings;
 
     std::vector<SlotPermission> op_stack_perms;
+    // every slot whose permissions were ever narrowed lies in [restricted_lo, restricted_hi);
+    // outside it all slots are readable and writable, so range checks skip the per-slot scan
+    size_t restricted_lo = SIZE_MAX;
+    size_t restricted_hi = 0;
 
     Mode cur_mode = Mode::Privileged;
 
+    uint64_t fuel = 0;
+    bool fuel_metered = false;
+
+    blackbox::tools::Xoshiro256pp rng;
+
+    Limits limits;
+    size_t frame_slots_used = 0; // live frame slots across all coroutines
+
     // fd
     struct FD {
-        enum class Kind : uint8_t { Closed, StdIn, StdOut, StdErr, File };
+        enum class Kind : uint8_t { Closed, StdIn, StdOut, StdErr, File, Pipe, Fifo };
         Kind kind = Kind::Closed;
         std::unique_ptr<std::fstream> file;
 
+        // File remembers how it was opened so FCOPY can reach it with an OS descriptor
+        std::string path;
+        uint8_t mode = 0;
+
+        // Pipe and Fifo use the OS descriptor directly; in is set on read ends
+        int os_fd = -1;
+        std::unique_ptr<InputBuffer> in;
+
+        FD() = default;
+        FD(const FD&) = delete;
+        FD& operator=(const FD&) = delete;
+        ~FD() { close(); }
+
         std::istream* reader();
         std::ostream* writer();
+        void close();
     };
     std::array<FD, FILE_DESCRIPTORS> fds;
+    InputBuffer stdin_buf{0};
+    Reactor reactor;
+    static constexpr uint32_t STDIN_TAG = FILE_DESCRIPTORS; // reactor tag of the host stdin
+    static constexpr int WOULD_BLOCK = -2;
+
+    struct ChannelPort {
+        std::shared_ptr<Channel> channel;
+        bool sender = false;
+    };
+    std::array<ChannelPort, MAX_CHANNELS> channels;
+
+    Screen screen;
+
+    // EXECBG children by job id; -1 once reaped
+    std::vector<int64_t> jobs;
 
     std::array<size_t, MAX_SYSCALLS> syscall_table{};
     std::array<bool, MAX_SYSCALLS> syscall_registered{};
@@ -89,14 +214,19 @@ class VM {
     uint64_t fetch_u64();
     int64_t fetch_i64();
     size_t fetch_reg();
+    uint64_t fetch_indexed_addr();
 
     int64_t& fetch_writable();
+    int64_t& fetch_atomic_slot(std::string_view opname);
+    size_t fetch_heap_base(std::string_view opname);
+    void check_heap_range(size_t base, size_t count, bool write, std::string_view opname);
+    void note_restricted(size_t first, size_t end);
 
     void expect_bytes(size_t needed);
 
     int64_t& var(uint32_t slot);
     int64_t& global_var(uint32_t slot);
-    int64_t& heap_addr(uint32_t addr);
+    int64_t& heap_addr(uint64_t addr, bool write);
 
     void push_frame(size_t frame_size, size_t ret_pc);
     void pop_frame();
@@ -104,11 +234,44 @@ class VM {
     void operand_push(int64_t value);
     int64_t operand_pop();
 
+    void save_context(Coroutine& co);
+    void load_context(Coroutine& co);
+    void switch_to(size_t id);
+    void wake_timers();
+    bool schedule();
+    void yield_current();
+    void sleep_current(uint64_t ms);
+    void finish_coroutine();
+    void cancel_wait(size_t id);
+    bool yield_if_blocked_on_stdin();
+    bool yield_to_retry();
+
+    FD& fetch_fd(std::string_view opname);
+    void close_fd(uint8_t fd);
+    void attach_os_fd(uint8_t fd, FD::Kind kind, int os_fd, bool read_end);
+    int read_byte(FD& f, bool nonblocking, std::string_view opname);
+    bool write_byte(FD& f, uint8_t byte, bool nonblocking, std::string_view opname);
+    int open_for_copy(FD& f, bool write);
+    void finish_copy(FD& f, int os_fd, bool write);
+
+    Channel& channel_port(uint8_t id, bool sender, std::string_view opname);
+    void close_channels();
+
     [[noreturn]] void hard_fault(FaultType type, std::string_view message);
     void raise_fault(FaultType type, std::string_view message);
 
     void require_privileged(std::string_view opname);
 
+    std::vector<std::string> fetch_command(uint8_t flags, std::string_view opname);
+
+    void charge_fuel();
+
+    void check_heap_quota(size_t new_size, std::string_view opname);
+    void check_frame_quota(size_t frame_size, std::string_view opname);
+    int64_t intern_string(std::string_view s);
+    std::string_view string_at(int64_t handle, std::string_view opname);
+    void collect_strings();
+
     using Handler = void (VM::*)();
     static const std::array<Handler, 256> dispatch_table;
 
@@ -124,6 +287,11 @@ class VM {
     void op_mod();
     void op_inc();
     void op_dec();
+    void op_add3();
+    void op_sub3();
+    void op_mul3();
+    void op_div3();
+    void op_mod3();
 
     // bitwise
     void op_and();
@@ -132,6 +300,11 @@ class VM {
     void op_not();
     void op_shl();
     void op_shr();
+    void op_and3();
+    void op_or3();
+    void op_xor3();
+    void op_shl3();
+    void op_shr3();
 
     // registers
     void op_push();
@@ -146,10 +319,28 @@ class VM {
     void op_jge();
     void op_jb();
     void op_jae();
+    void op_loop();
     void op_call();
     void op_ret();
     void op_HLT();
 
+    // coroutines
+    void op_cocreate();
+    void op_yield();
+    void op_resume();
+
+    // atomics
+    void op_cas();
+    void op_fetchadd();
+    void op_xchg();
+    void op_wait();
+    void op_wake();
+
+    // channels
+    void op_chsend();
+    void op_chrecv();
+    void op_chtry();
+
     // memory
     void op_loadref();
     void op_storeref();
@@ -157,11 +348,60 @@ class VM {
     void op_grow();
     void op_resize();
     void op_free();
+    void op_halloc();
+    void op_hfree();
+    uint8_t* packed_element(size_t base, int64_t index, size_t width, bool write,
+                            std::string_view opname);
+    void packed_load(size_t width, bool sign, std::string_view opname);
+    void packed_store(size_t width, std::string_view opname);
+    void op_loadb();
+    void op_loadw();
+    void op_loadd();
+    void op_loadsb();
+    void op_loadsw();
+    void op_loadsd();
+    void op_storeb();
+    void op_storew();
+    void op_stored();
+    void op_heapfind();
+    void op_memcpy();
+    void op_memset();
+    void op_memcmp();
+    void op_memmove();
 
     // strings
     void op_loadstr();
     void op_printstr();
     void op_eprintstr();
+    void op_strcat();
+    void op_strlen();
+    void op_substr();
+    void op_strcmp();
+    void op_charat();
+    void op_strfromheap();
+    void op_strfind();
+    void op_strchr();
+    void op_strsplit();
+    void op_itoa();
+    void op_atoi();
+    void op_strfmt();
+
+    // vector
+    void vector_map(simd::VecOp op, std::string_view opname);
+    void op_vadd();
+    void op_vsub();
+    void op_vmul();
+    void op_vand();
+    void op_vmin();
+    void op_vmax();
+    void op_vsum();
+    void op_vdot();
+
+    // screen
+    void op_scrinit();
+    void op_scrput();
+    void op_scrblit();
+    void op_scrflush();
 
     // io
     void op_write();
@@ -179,11 +419,22 @@ class VM {
     void op_fread();
     void op_fwrite();
     void op_fseek();
+    void op_fcopy();
+    void op_fmap();
+    void op_funmap();
+    void op_freadnb();
+    void op_fwritenb();
+    void op_pipe();
+    void op_poll();
 
     // system
     void op_exec();
+    void op_execx();
+    void op_execbg();
+    void op_execwait();
     void op_sleep();
     void op_rand();
+    void op_randfill();
     void op_getkey();
     void op_clrscr();
     void op_getarg();
@@ -200,6 +451,8 @@ class VM {
     void op_regfault();
     void op_faultret();
     void op_getfault();
+    void op_refuel();
+    void op_getfuel();
 
     // debug
     void op_break();
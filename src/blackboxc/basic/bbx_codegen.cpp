@@ -11,6 +11,20 @@ std::string BlackboxCodeGen::reg(int r) {
     return std::format("R{}", r);
 }
 
+std::string BlackboxCodeGen::value(const Value& v) {
+    switch (v.kind) {
+        case Value::Kind::Reg:
+            return reg(v.num);
+        case Value::Kind::Imm:
+            return std::to_string(v.num);
+        case Value::Kind::Local:
+            return std::format("VAR {}", v.num);
+        case Value::Kind::Global:
+            return std::format("[{}]", v.name);
+    }
+    return {};
+}
+
 void BlackboxCodeGen::code(std::string_view line) {
     code_sec_ += line;
     code_sec_ += '\n';
@@ -89,20 +103,23 @@ void BlackboxCodeGen::emit_add(int dst, int src) {
     code(std::format("    ADD {}, {}", reg(dst), reg(src)));
 }
 
-void BlackboxCodeGen::emit_sub(int dst, int src) {
-    code(std::format("    SUB {}, {}", reg(dst), reg(src)));
-}
-
-void BlackboxCodeGen::emit_mul(int dst, int src) {
-    code(std::format("    MUL {}, {}", reg(dst), reg(src)));
-}
-
-void BlackboxCodeGen::emit_div(int dst, int src) {
-    code(std::format("    DIV {}, {}", reg(dst), reg(src)));
-}
-
-void BlackboxCodeGen::emit_mod(int dst, int src) {
-    code(std::format("    MOD {}, {}", reg(dst), reg(src)));
+// the two-operand form when a is already in dst, otherwise the three-operand one, which saves
+// copying a into dst first
+void BlackboxCodeGen::emit_binop(BinOp op, int dst, const Value& a, const Value& b) {
+    static constexpr std::string_view names[] = {"ADD", "SUB", "MUL", "DIV", "MOD",
+                                                 "AND", "OR",  "XOR", "SHL", "SHR"};
+    std::string_view name = names[static_cast<size_t>(op)];
+    bool in_place = a.kind == Value::Kind::Reg && a.num == dst;
+    // SHL and SHR only shift a register by a register or an immediate
+    if ((op == BinOp::Shl || op == BinOp::Shr) && b.kind != Value::Kind::Reg &&
+        b.kind != Value::Kind::Imm) {
+        in_place = false;
+    }
+    if (in_place) {
+        code(std::format("    {} {}, {}", name, reg(dst), value(b)));
+    } else {
+        code(std::format("    {}3 {}, {}, {}", name, reg(dst), value(a), value(b)));
+    }
 }
 
 void BlackboxCodeGen::emit_inc(int r) {
@@ -113,30 +130,10 @@ void BlackboxCodeGen::emit_dec(int r) {
     code(std::format("    DEC {}", reg(r)));
 }
 
-void BlackboxCodeGen::emit_and(int dst, int src) {
-    code(std::format("    AND {}, {}", reg(dst), reg(src)));
-}
-
-void BlackboxCodeGen::emit_or(int dst, int src) {
-    code(std::format("    OR {}, {}", reg(dst), reg(src)));
-}
-
-void BlackboxCodeGen::emit_xor(int dst, int src) {
-    code(std::format("    XOR {}, {}", reg(dst), reg(src)));
-}
-
 void BlackboxCodeGen::emit_not(int r) {
     code(std::format("    NOT {}", reg(r)));
 }
 
-void BlackboxCodeGen::emit_shl(int dst, int src) {
-    code(std::format("    SHL {}, {}", reg(dst), reg(src)));
-}
-
-void BlackboxCodeGen::emit_shr(int dst, int src) {
-    code(std::format("    SHR {}, {}", reg(dst), reg(src)));
-}
-
 void BlackboxCodeGen::emit_cmp(int r1, int r2) {
     code(std::format("    CMP {}, {}", reg(r1), reg(r2)));
 }
@@ -169,6 +166,11 @@ void BlackboxCodeGen::emit_jae(const std::string& label) {
     code(std::format("    JAE {}", label));
 }
 
+void BlackboxCodeGen::emit_loop(uint32_t slot, int32_t step, const Value& limit,
+                                const std::string& label) {
+    code(std::format("    LOOP VAR {}, {}, {}, {}", slot, step, value(limit), label));
+}
+
 void BlackboxCodeGen::emit_call(const std::string& label) {
     code(std::format("    CALL {}", label));
 }
@@ -222,6 +224,38 @@ void BlackboxCodeGen::emit_eprint_char(int r) {
     code(std::format("    EPRINTCHAR {}", reg(r)));
 }
 
+void BlackboxCodeGen::emit_strcat(int dst, int a, int b) {
+    code(std::format("    STRCAT {}, {}, {}", reg(dst), reg(a), reg(b)));
+}
+
+void BlackboxCodeGen::emit_strlen(int dst, int src) {
+    code(std::format("    STRLEN {}, {}", reg(dst), reg(src)));
+}
+
+void BlackboxCodeGen::emit_substr(int dst, int src, int start, int len) {
+    code(std::format("    SUBSTR {}, {}, {}, {}", reg(dst), reg(src), reg(start), reg(len)));
+}
+
+void BlackboxCodeGen::emit_strcmp(int dst, int a, int b) {
+    code(std::format("    STRCMP {}, {}, {}", reg(dst), reg(a), reg(b)));
+}
+
+void BlackboxCodeGen::emit_itoa(int dst, int src, int base) {
+    code(std::format("    ITOA {}, {}, {}", reg(dst), reg(src), base));
+}
+
+void BlackboxCodeGen::emit_atoi(int dst, int src) {
+    code(std::format("    ATOI {}, {}", reg(dst), reg(src)));
+}
+
+void BlackboxCodeGen::emit_strfmt(int dst, int tmpl, const std::vector<int>& args) {
+    std::string line = std::format("    STRFMT {}, {}", reg(dst), reg(tmpl));
+    for (int a : args) {
+        line += std::format(", {}", reg(a));
+    }
+    code(line);
+}
+
 void BlackboxCodeGen::emit_newline() {
     code("    MOV R1, 10");
     code("    PRINTCHAR R1");
@@ -264,6 +298,10 @@ void BlackboxCodeGen::emit_fseek(uint8_t fd, int r) {
     code(std::format("    FSEEK F{}, {}", fd, reg(r)));
 }
 
+void BlackboxCodeGen::emit_fcopy(uint8_t src, uint8_t dst, int r) {
+    code(std::format("    FCOPY F{}, F{}, {}", src, dst, reg(r)));
+}
+
 void BlackboxCodeGen::emit_sleep(int r) {
     code(std::format("    SLEEP {}", reg(r)));
 }
@@ -289,6 +327,22 @@ void BlackboxCodeGen::emit_clrscr() {
     code("    CLRSCR");
 }
 
+void BlackboxCodeGen::emit_scrinit(int w_reg, int h_reg) {
+    code(std::format("    SCRINIT {}, {}", reg(w_reg), reg(h_reg)));
+}
+
+void BlackboxCodeGen::emit_scrput(int x_reg, int y_reg, int ch_reg) {
+    code(std::format("    SCRPUT {}, {}, {}", reg(x_reg), reg(y_reg), reg(ch_reg)));
+}
+
+void BlackboxCodeGen::emit_scrblit(size_t heap_base) {
+    code(std::format("    SCRBLIT &{}", heap_base));
+}
+
+void BlackboxCodeGen::emit_scrflush() {
+    code("    SCRFLUSH");
+}
+
 void BlackboxCodeGen::emit_getarg(int r, uint32_t idx) {
     code(std::format("    GETARG {}, {}", reg(r), idx));
 }
@@ -329,11 +383,17 @@ void BlackboxCodeGen::emit_resize(int size) {
     code(std::format("    RESIZE {}", size));
 }
 
-void BlackboxCodeGen::emit_heap_read(int dst, int addr_reg) {
-    code(std::format("    MOV {}, &{}", reg(dst), reg(addr_reg)));
+void BlackboxCodeGen::emit_heap_read(int dst, size_t heap_base, int index_reg) {
+    code(std::format("    MOV {}, [{} + {}]", reg(dst), reg(index_reg), heap_base));
+}
+void BlackboxCodeGen::emit_heap_write(size_t heap_base, int index_reg, int src) {
+    code(std::format("    MOV [{} + {}], {}", reg(index_reg), heap_base, reg(src)));
+}
+void BlackboxCodeGen::emit_load_byte(int dst, size_t heap_base, int index_reg) {
+    code(std::format("    LOADB {}, &{}, {}", reg(dst), heap_base, reg(index_reg)));
 }
-void BlackboxCodeGen::emit_heap_write(int addr_reg, int src) {
-    code(std::format("    MOV &{}, {}", reg(addr_reg), reg(src)));
+void BlackboxCodeGen::emit_store_byte(size_t heap_base, int index_reg, int src) {
+    code(std::format("    STOREB &{}, {}, {}", heap_base, reg(index_reg), reg(src)));
 }
 
 } // namespace basic
\ No newline at end of file
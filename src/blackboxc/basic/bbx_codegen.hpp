@@ -30,10 +30,7 @@ class BlackboxCodeGen final : public CodeGen {
     void emit_pop(int reg) override;
 
     void emit_add(int dst, int src) override;
-    void emit_sub(int dst, int src) override;
-    void emit_mul(int dst, int src) override;
-    void emit_div(int dst, int src) override;
-    void emit_mod(int dst, int src) override;
+    void emit_binop(BinOp op, int dst, const Value& a, const Value& b) override;
     void emit_inc(int reg) override;
     void emit_dec(int reg) override;
     void emit_inc_var(uint32_t slot) override;
@@ -41,12 +38,7 @@ class BlackboxCodeGen final : public CodeGen {
     void emit_inc_global(const std::string& name) override;
     void emit_dec_global(const std::string& name) override;
 
-    void emit_and(int dst, int src) override;
-    void emit_or(int dst, int src) override;
-    void emit_xor(int dst, int src) override;
     void emit_not(int reg) override;
-    void emit_shl(int dst, int src) override;
-    void emit_shr(int dst, int src) override;
 
     void emit_cmp(int r1, int r2) override;
     void emit_jmp(const std::string& label) override;
@@ -56,6 +48,8 @@ class BlackboxCodeGen final : public CodeGen {
     void emit_jge(const std::string& label) override;
     void emit_jb(const std::string& label) override;
     void emit_jae(const std::string& label) override;
+    void emit_loop(uint32_t slot, int32_t step, const Value& limit,
+                   const std::string& label) override;
     void emit_call(const std::string& label) override;
     void emit_ret() override;
     void emit_HLT(uint8_t code) override;
@@ -71,6 +65,13 @@ class BlackboxCodeGen final : public CodeGen {
     void emit_eprint_reg(int reg) override;
     void emit_eprint_str(int reg) override;
     void emit_eprint_char(int reg) override;
+    void emit_strcat(int dst, int a, int b) override;
+    void emit_strlen(int dst, int src) override;
+    void emit_substr(int dst, int src, int start, int len) override;
+    void emit_strcmp(int dst, int a, int b) override;
+    void emit_itoa(int dst, int src, int base) override;
+    void emit_atoi(int dst, int src) override;
+    void emit_strfmt(int dst, int tmpl, const std::vector<int>& args) override;
     void emit_newline() override;
     void emit_enewline() override;
     void emit_read(int reg) override;
@@ -82,6 +83,7 @@ class BlackboxCodeGen final : public CodeGen {
     void emit_fread(uint8_t fd, int reg) override;
     void emit_fwrite(uint8_t fd, int reg) override;
     void emit_fseek(uint8_t fd, int reg) override;
+    void emit_fcopy(uint8_t src, uint8_t dst, int reg) override;
 
     void emit_sleep(int reg) override;
     void emit_exec(const std::string& cmd, int reg) override;
@@ -90,6 +92,10 @@ class BlackboxCodeGen final : public CodeGen {
                          const std::string& max_expr) override;
     void emit_getkey(int reg) override;
     void emit_clrscr() override;
+    void emit_scrinit(int w_reg, int h_reg) override;
+    void emit_scrput(int x_reg, int y_reg, int ch_reg) override;
+    void emit_scrblit(size_t heap_base) override;
+    void emit_scrflush() override;
     void emit_getarg(int reg, uint32_t idx) override;
     void emit_getargc(int reg) override;
     void emit_getenv(int reg, const std::string& name) override;
@@ -99,8 +105,10 @@ class BlackboxCodeGen final : public CodeGen {
     void emit_grow(int size) override;
     void emit_resize(int size) override;
 
-    void emit_heap_read(int dst, int addr_reg) override;
-    void emit_heap_write(int addr_reg, int src) override;
+    void emit_heap_read(int dst, size_t heap_base, int index_reg) override;
+    void emit_heap_write(size_t heap_base, int index_reg, int src) override;
+    void emit_load_byte(int dst, size_t heap_base, int index_reg) override;
+    void emit_store_byte(size_t heap_base, int index_reg, int src) override;
 
     void emit_raw(std::string_view line) override;
 
@@ -112,6 +120,7 @@ class BlackboxCodeGen final : public CodeGen {
     std::string code_sec_;
 
     static std::string reg(int r);
+    static std::string value(const Value& v);
 
     void code(std::string_view line);
     void code_comment(std::string_view comment, std::string_view line);
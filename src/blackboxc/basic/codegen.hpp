@@ -4,11 +4,25 @@
 
 #ifndef BLACKBOX_CODEGEN_HPP
 #define BLACKBOX_CODEGEN_HPP
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace basic {
+// a source operand of emit_binop: a scratch register, or a value the instruction reads in place
+struct Value {
+    enum class Kind { Reg, Imm, Local, Global };
+    Kind kind = Kind::Reg;
+    int32_t num = 0;  // register, immediate or frame slot
+    std::string name; // bss name of a global
+
+    static Value reg(int r) { return {Kind::Reg, r, {}}; }
+};
+
+enum class BinOp { Add, Sub, Mul, Div, Mod, And, Or, Xor, Shl, Shr };
+
 class CodeGen {
   public:
     virtual ~CodeGen() = default;
@@ -31,10 +45,8 @@ class CodeGen {
     virtual void emit_pop(int reg) = 0;
 
     virtual void emit_add(int dst, int src) = 0;
-    virtual void emit_sub(int dst, int src) = 0;
-    virtual void emit_mul(int dst, int src) = 0;
-    virtual void emit_div(int dst, int src) = 0;
-    virtual void emit_mod(int dst, int src) = 0;
+    // dst = a op b
+    virtual void emit_binop(BinOp op, int dst, const Value& a, const Value& b) = 0;
     virtual void emit_inc(int reg) = 0;
     virtual void emit_dec(int reg) = 0;
     virtual void emit_inc_var(uint32_t slot) = 0;
@@ -42,12 +54,7 @@ class CodeGen {
     virtual void emit_inc_global(const std::string& name) = 0;
     virtual void emit_dec_global(const std::string& name) = 0;
 
-    virtual void emit_and(int dst, int src) = 0;
-    virtual void emit_or(int dst, int src) = 0;
-    virtual void emit_xor(int dst, int src) = 0;
     virtual void emit_not(int reg) = 0;
-    virtual void emit_shl(int dst, int src) = 0;
-    virtual void emit_shr(int dst, int src) = 0;
 
     virtual void emit_cmp(int r1, int r2) = 0;
     virtual void emit_jmp(const std::string& label) = 0;
@@ -57,6 +64,9 @@ class CodeGen {
     virtual void emit_jge(const std::string& label) = 0;
     virtual void emit_jb(const std::string& label) = 0;
     virtual void emit_jae(const std::string& label) = 0;
+    // slot += step, then jump to label unless the slot has passed limit
+    virtual void emit_loop(uint32_t slot, int32_t step, const Value& limit,
+                           const std::string& label) = 0;
     virtual void emit_call(const std::string& label) = 0;
     virtual void emit_ret() = 0;
     virtual void emit_HLT(uint8_t code) = 0;
@@ -72,6 +82,13 @@ class CodeGen {
     virtual void emit_eprint_reg(int reg) = 0;
     virtual void emit_eprint_str(int reg) = 0;
     virtual void emit_eprint_char(int reg) = 0;
+    virtual void emit_strcat(int dst, int a, int b) = 0;
+    virtual void emit_strlen(int dst, int src) = 0;
+    virtual void emit_substr(int dst, int src, int start, int len) = 0;
+    virtual void emit_strcmp(int dst, int a, int b) = 0;
+    virtual void emit_itoa(int dst, int src, int base) = 0;
+    virtual void emit_atoi(int dst, int src) = 0;
+    virtual void emit_strfmt(int dst, int tmpl, const std::vector<int>& args) = 0;
     virtual void emit_newline() = 0;
     virtual void emit_enewline() = 0;
     virtual void emit_read(int reg) = 0;
@@ -83,6 +100,7 @@ class CodeGen {
     virtual void emit_fread(uint8_t fd, int reg) = 0;
     virtual void emit_fwrite(uint8_t fd, int reg) = 0;
     virtual void emit_fseek(uint8_t fd, int reg) = 0;
+    virtual void emit_fcopy(uint8_t src, uint8_t dst, int reg) = 0;
 
     virtual void emit_sleep(int reg) = 0;
     virtual void emit_exec(const std::string& cmd, int reg) = 0;
@@ -91,6 +109,10 @@ class CodeGen {
                                  const std::string& max_expr) = 0;
     virtual void emit_getkey(int reg) = 0;
     virtual void emit_clrscr() = 0;
+    virtual void emit_scrinit(int w_reg, int h_reg) = 0;
+    virtual void emit_scrput(int x_reg, int y_reg, int ch_reg) = 0;
+    virtual void emit_scrblit(size_t heap_base) = 0;
+    virtual void emit_scrflush() = 0;
     virtual void emit_getarg(int reg, uint32_t idx) = 0;
     virtual void emit_getargc(int reg) = 0;
     virtual void emit_getenv(int reg, const std::string& name) = 0;
@@ -105,8 +127,10 @@ class CodeGen {
     virtual void emit_grow(int size) = 0;
     virtual void emit_resize(int size) = 0;
 
-    virtual void emit_heap_read(int dst, int addr_reg) = 0;
-virtual void emit_heap_write(int addr_reg, int src) = 0;
+    virtual void emit_heap_read(int dst, size_t heap_base, int index_reg) = 0;
+    virtual void emit_heap_write(size_t heap_base, int index_reg, int src) = 0;
+    virtual void emit_load_byte(int dst, size_t heap_base, int index_reg) = 0;
+    virtual void emit_store_byte(size_t heap_base, int index_reg, int src) = 0;
 };
 } // namespace basic
 #endif // BLACKBOX_CODEGEN_HPP
\ No newline at end of file
@@ -15,7 +15,7 @@ std::optional<std::string> Parser::emit_atom(const char* s, const char** end, in
     // parenthesized expression
     if (*s == '(') {
         s++;
-        if (auto err = emit_expr(s, out_reg)) {
+        if (auto err = emit_expr_p(s, end, out_reg)) {
             return err;
         }
         s = skip_ws(*end);
@@ -26,6 +26,37 @@ std::optional<std::string> Parser::emit_atom(const char* s, const char** end, in
         return std::nullopt;
     }
 
+    // string literal
+    if (*s == '"') {
+        const char* str_end = strchr(s + 1, '"');
+        if (!str_end) {
+            return error("unterminated string in expression");
+        }
+        std::string dname = std::format("_p{}", uid_++);
+        active_cg().emit_data_str(dname, std::string(s + 1, str_end - s - 1));
+        int r = ralloc_acquire();
+        if (r < 0) {
+            return error("out of scratch registers");
+        }
+        active_cg().emit_load_str(r, dname);
+        set_str_reg(r, true);
+        *out_reg = r;
+        *end = str_end + 1;
+        return std::nullopt;
+    }
+
+    // character literal: 'c'
+    if (*s == '\'' && s[1] != '\0' && s[2] == '\'') {
+        int r = ralloc_acquire();
+        if (r < 0) {
+            return error("out of scratch registers");
+        }
+        active_cg().emit_movi(r, static_cast<unsigned char>(s[1]));
+        *out_reg = r;
+        *end = s + 3;
+        return std::nullopt;
+    }
+
     // numeric literal
     if (*s == '-' || isdigit(static_cast<unsigned char>(*s))) {
         char* endptr;
@@ -73,19 +104,42 @@ std::optional<std::string> Parser::emit_atom(const char* s, const char** end, in
                 }
                 *end = index_ptr + 1;
 
-                int addr_reg = ralloc_acquire();
-                active_cg().emit_movi(addr_reg, static_cast<int32_t>(array_info.base));
-                active_cg().emit_add(addr_reg, index_reg);
-                ralloc_release(index_reg);
+                if (array_info.bytes) {
+                    active_cg().emit_load_byte(index_reg, array_info.base, index_reg);
+                    set_str_reg(index_reg, false);
+                    *out_reg = index_reg;
+                    return std::nullopt;
+                }
 
-                int dst = ralloc_acquire();
-                active_cg().emit_heap_read(dst, addr_reg);
-                ralloc_release(addr_reg);
-                *out_reg = dst;
+                active_cg().emit_heap_read(index_reg, array_info.base, index_reg);
+                set_str_reg(index_reg, false);
+                *out_reg = index_reg;
                 return std::nullopt;
             }
         }
 
+        // builtins, unless the program defines a function of the same name
+        if (*after == '(' && !find_func_entry(resolve_func_name(name))) {
+            if (equals_ci(name, "LEN")) {
+                return emit_len(after + 1, end, out_reg);
+            }
+            if (equals_ci(name, "MID")) {
+                return emit_mid(after + 1, end, out_reg);
+            }
+            if (equals_ci(name, "STR")) {
+                return emit_to_string(after + 1, end, out_reg, 10);
+            }
+            if (equals_ci(name, "HEX")) {
+                return emit_to_string(after + 1, end, out_reg, 16);
+            }
+            if (equals_ci(name, "VAL")) {
+                return emit_val(after + 1, end, out_reg);
+            }
+            if (equals_ci(name, "FORMAT")) {
+                return emit_format(after + 1, end, out_reg);
+            }
+        }
+
         // function call
         if (*after == '(') {
             std::string resolved_name = resolve_func_name(name);
@@ -169,15 +223,7 @@ std::optional<std::string> Parser::emit_atom(const char* s, const char** end, in
 
         // plain variable
         *end = p;
-        Variable* v = active_scope().find(name);
-        if (!v && !current_ns_ && name.find("__") != std::string::npos) {
-            for (auto& ns : namespaces_) {
-                if (auto* nv = ns.scope.find(name)) {
-                    v = nv;
-                    break;
-                }
-            }
-        }
+        Variable* v = find_variable(name);
         if (!v) {
             return error(std::format("undefined variable '{}'", name));
         }
@@ -204,6 +250,7 @@ std::optional<std::string> Parser::emit_atom(const char* s, const char** end, in
             } else {
                 active_cg().emit_load_str(r, v->data_name);
             }
+            set_str_reg(r, v->type == VarType::Str);
             *out_reg = r;
         }
         return std::nullopt;
@@ -212,6 +259,19 @@ std::optional<std::string> Parser::emit_atom(const char* s, const char** end, in
     return error(std::format("Unexpected character '{}' in expr", *s));
 }
 
+// a namespace variable is also reachable by its mangled name from outside any namespace
+Variable* Parser::find_variable(const std::string& name) {
+    Variable* v = active_scope().find(name);
+    if (!v && !current_ns_ && name.find("__") != std::string::npos) {
+        for (auto& ns : namespaces_) {
+            if (auto* nv = ns.scope.find(name)) {
+                return nv;
+            }
+        }
+    }
+    return v;
+}
+
 std::optional<std::string> Parser::emit_unary(const char* s, const char** end, int* out_reg) {
     s = skip_ws(s);
     if (*s == '~') {
@@ -226,43 +286,174 @@ std::optional<std::string> Parser::emit_unary(const char* s, const char** end, i
     return emit_atom(s, end, out_reg);
 }
 
+namespace {
+bool at_bitwise_op(const char* s) {
+    return *s == '&' || *s == '|' || *s == '^' || (s[0] == '<' && s[1] == '<') ||
+           (s[0] == '>' && s[1] == '>');
+}
+bool at_mul_op(const char* s) {
+    return *s == '*' || *s == '/' || *s == '%';
+}
+} // namespace
+
+// an integer literal or plain integer variable at s that an instruction can read in place. nullopt
+// when the atom needs code to produce its value, or when an operator binding tighter than level
+// follows it, so the usual emit_* path takes over
+std::optional<Value> Parser::fold_operand(const char* s, const char** end, OpLevel level) {
+    s = skip_ws(s);
+    const char* p = s;
+    Value v;
+    if (*s == '\'' && s[1] != '\0' && s[2] == '\'') {
+        v = {Value::Kind::Imm, static_cast<unsigned char>(s[1]), {}};
+        p = s + 3;
+    } else if (isdigit(static_cast<unsigned char>(*s)) ||
+               (*s == '-' && isdigit(static_cast<unsigned char>(s[1])))) {
+        char* endptr;
+        v = {Value::Kind::Imm, static_cast<int32_t>(strtol(s, &endptr, 10)), {}};
+        p = endptr;
+    } else if (isalpha(static_cast<unsigned char>(*s)) || *s == '_') {
+        std::string name;
+        while (*p && (isalnum(static_cast<unsigned char>(*p)) || *p == '_')) {
+            name += *p++;
+        }
+        const char* after = skip_ws(p);
+        if (*after == '[' || *after == '(' || *after == '.') {
+            return std::nullopt;
+        }
+        Variable* var = find_variable(name);
+        if (!var || var->is_ref || var->type != VarType::Int) {
+            return std::nullopt;
+        }
+        if (var->is_global) {
+            v = {Value::Kind::Global, 0, var->name};
+        } else {
+            v = {Value::Kind::Local, static_cast<int32_t>(var->slot), {}};
+        }
+    } else {
+        return std::nullopt;
+    }
+
+    const char* next = skip_ws(p);
+    if ((level != OpLevel::Bitwise && at_bitwise_op(next)) ||
+        (level == OpLevel::Add && at_mul_op(next))) {
+        return std::nullopt;
+    }
+    *end = p;
+    return v;
+}
+
+// the right operand of an operator at level: folded when possible, else evaluated into a scratch
+// register
+std::optional<std::string> Parser::emit_operand(const char* s, const char** end, OpLevel level,
+                                                Value* out) {
+    if (auto v = fold_operand(s, end, level)) {
+        *out = *v;
+        return std::nullopt;
+    }
+    int r;
+    std::optional<std::string> err;
+    switch (level) {
+        case OpLevel::Bitwise:
+            err = emit_unary(s, end, &r);
+            break;
+        case OpLevel::Mul:
+            err = emit_bitwise(s, end, &r);
+            break;
+        case OpLevel::Add:
+            err = emit_mul_expr(s, end, &r);
+            break;
+    }
+    if (!err) {
+        *out = Value::reg(r);
+    }
+    return err;
+}
+
+// *lreg = lhs op rhs. *lreg is -1 while lhs is still folded; the result then goes to rhs's
+// scratch register if it has one, else to a fresh one
+std::optional<std::string> Parser::emit_fold_binop(BinOp op, int* lreg, const Value& lhs,
+                                                   const Value& rhs) {
+    int dst = *lreg;
+    if (dst < 0) {
+        dst = rhs.kind == Value::Kind::Reg ? rhs.num : ralloc_acquire();
+        if (dst < 0) {
+            return error("out of scratch registers");
+        }
+        set_str_reg(dst, false);
+    }
+    active_cg().emit_binop(op, dst, lhs, rhs);
+    *lreg = dst;
+    return std::nullopt;
+}
+
+// a folded lhs with no operator after it still has to end up in a register
+std::optional<std::string> Parser::emit_lhs(const char* s, const char** end, OpLevel level,
+                                            int* lreg, Value* lhs) {
+    const char* p;
+    auto v = fold_operand(s, &p, level);
+    bool op_follows = v && (level == OpLevel::Bitwise ? at_bitwise_op(skip_ws(p))
+                            : level == OpLevel::Mul   ? at_mul_op(skip_ws(p))
+                                                      : (*skip_ws(p) == '+' || *skip_ws(p) == '-'));
+    if (op_follows) {
+        *end = p;
+        *lreg = -1;
+        *lhs = *v;
+        return std::nullopt;
+    }
+    std::optional<std::string> err;
+    switch (level) {
+        case OpLevel::Bitwise:
+            err = emit_unary(s, end, lreg);
+            break;
+        case OpLevel::Mul:
+            err = emit_bitwise(s, end, lreg);
+            break;
+        case OpLevel::Add:
+            err = emit_mul_expr(s, end, lreg);
+            break;
+    }
+    if (!err) {
+        *lhs = Value::reg(*lreg);
+    }
+    return err;
+}
+
 std::optional<std::string> Parser::emit_bitwise(const char* s, const char** end, int* out_reg) {
     int lreg;
-    if (auto err = emit_unary(s, end, &lreg)) {
+    Value lhs;
+    if (auto err = emit_lhs(s, end, OpLevel::Bitwise, &lreg, &lhs)) {
         return err;
     }
     s = skip_ws(*end);
 
-    while (*s == '&' || *s == '|' || *s == '^' || (s[0] == '<' && s[1] == '<') ||
-           (s[0] == '>' && s[1] == '>')) {
-        char op0 = *s, op1 = *(s + 1);
+    while (at_bitwise_op(s)) {
+        char op0 = *s;
         if (*s == '&' || *s == '|' || *s == '^') {
             s++;
         } else {
             s += 2;
         }
 
-        s = skip_ws(s);
-        int rreg;
-        if (auto err = emit_unary(s, end, &rreg)) {
+        Value rhs;
+        if (auto err = emit_operand(s, end, OpLevel::Bitwise, &rhs)) {
             ralloc_release(lreg);
             return err;
         }
         s = skip_ws(*end);
 
-        if (op0 == '&') {
-            active_cg().emit_and(lreg, rreg);
-        } else if (op0 == '|') {
-            active_cg().emit_or(lreg, rreg);
-        } else if (op0 == '^') {
-            active_cg().emit_xor(lreg, rreg);
-        } else if (op0 == '<') {
-            active_cg().emit_shl(lreg, rreg);
-        } else {
-            active_cg().emit_shr(lreg, rreg);
+        BinOp op = op0 == '&'   ? BinOp::And
+                   : op0 == '|' ? BinOp::Or
+                   : op0 == '^' ? BinOp::Xor
+                   : op0 == '<' ? BinOp::Shl
+                                : BinOp::Shr;
+        auto err = emit_fold_binop(op, &lreg, lhs, rhs);
+        if (rhs.kind == Value::Kind::Reg && rhs.num != lreg) {
+            ralloc_release(rhs.num);
         }
-
-        ralloc_release(rreg);
+        if (err) {
+            return err;
+        }
+        lhs = Value::reg(lreg);
     }
     *end = s;
     *out_reg = lreg;
@@ -271,30 +462,30 @@ std::optional<std::string> Parser::emit_bitwise(const char* s, const char** end,
 
 std::optional<std::string> Parser::emit_mul_expr(const char* s, const char** end, int* out_reg) {
     int lreg;
-    if (auto err = emit_bitwise(s, end, &lreg)) {
+    Value lhs;
+    if (auto err = emit_lhs(s, end, OpLevel::Mul, &lreg, &lhs)) {
         return err;
     }
     s = skip_ws(*end);
 
-    while (*s == '*' || *s == '/' || *s == '%') {
-        char op = *s++;
-        s = skip_ws(s);
-        int rreg;
-        if (auto err = emit_bitwise(s, end, &rreg)) {
+    while (at_mul_op(s)) {
+        char op0 = *s++;
+        Value rhs;
+        if (auto err = emit_operand(s, end, OpLevel::Mul, &rhs)) {
             ralloc_release(lreg);
             return err;
         }
         s = skip_ws(*end);
 
-        if (op == '*') {
-            active_cg().emit_mul(lreg, rreg);
-        } else if (op == '/') {
-            active_cg().emit_div(lreg, rreg);
-        } else {
-            active_cg().emit_mod(lreg, rreg);
+        BinOp op = op0 == '*' ? BinOp::Mul : op0 == '/' ? BinOp::Div : BinOp::Mod;
+        auto err = emit_fold_binop(op, &lreg, lhs, rhs);
+        if (rhs.kind == Value::Kind::Reg && rhs.num != lreg) {
+            ralloc_release(rhs.num);
         }
-
-        ralloc_release(rreg);
+        if (err) {
+            return err;
+        }
+        lhs = Value::reg(lreg);
     }
     *end = s;
     *out_reg = lreg;
@@ -302,59 +493,208 @@ std::optional<std::string> Parser::emit_mul_expr(const char* s, const char** end
 }
 
 std::optional<std::string> Parser::emit_expr(const char* s, int* out_reg) {
+    const char* end;
+    return emit_expr_p(s, &end, out_reg);
+}
+
+std::optional<std::string> Parser::emit_expr_p(const char* s, const char** end, int* out_reg) {
     const char* p = s;
     int lreg;
-    if (auto err = emit_mul_expr(p, &p, &lreg)) {
+    Value lhs;
+    if (auto err = emit_lhs(p, &p, OpLevel::Add, &lreg, &lhs)) {
         return err;
     }
     p = skip_ws(p);
 
     while (*p == '+' || *p == '-') {
         char op = *p++;
-        p = skip_ws(p);
-        int rreg;
-        if (auto err = emit_mul_expr(p, &p, &rreg)) {
+        Value rhs;
+        if (auto err = emit_operand(p, &p, OpLevel::Add, &rhs)) {
             ralloc_release(lreg);
             return err;
         }
         p = skip_ws(p);
-        if (op == '+') {
-            active_cg().emit_add(lreg, rreg);
-        } else {
-            active_cg().emit_sub(lreg, rreg);
+        auto err = emit_additive(op, &lreg, lhs, rhs);
+        if (rhs.kind == Value::Kind::Reg && rhs.num != lreg) {
+            ralloc_release(rhs.num);
         }
-        ralloc_release(rreg);
+        if (err) {
+            ralloc_release(lreg);
+            return err;
+        }
+        lhs = Value::reg(lreg);
     }
+    *end = p;
     *out_reg = lreg;
     return std::nullopt;
 }
 
-std::optional<std::string> Parser::emit_expr_p(const char* s, const char** end, int* out_reg) {
-    const char* p = s;
-    int lreg;
-    if (auto err = emit_mul_expr(p, &p, &lreg)) {
+// + on two strings concatenates; mixing a string with an integer is an error
+std::optional<std::string> Parser::emit_additive(char op, int* lreg, const Value& lhs,
+                                                 const Value& rhs) {
+    bool lstr = lhs.kind == Value::Kind::Reg && is_str_reg(lhs.num);
+    bool rstr = rhs.kind == Value::Kind::Reg && is_str_reg(rhs.num);
+    if (lstr || rstr) {
+        if (op != '+') {
+            return error("'-' is not defined on strings");
+        }
+        if (!lstr || !rstr) {
+            return error("cannot add a string and an integer");
+        }
+        active_cg().emit_strcat(*lreg, *lreg, rhs.num);
+        return std::nullopt;
+    }
+    return emit_fold_binop(op == '+' ? BinOp::Add : BinOp::Sub, lreg, lhs, rhs);
+}
+
+// LEN(s): the length of s in bytes
+std::optional<std::string> Parser::emit_len(const char* s, const char** end, int* out_reg) {
+    int r;
+    if (auto err = emit_expr_p(s, &s, &r)) {
         return err;
     }
-    p = skip_ws(p);
+    s = skip_ws(s);
+    if (*s != ')' || !is_str_reg(r)) {
+        ralloc_release(r);
+        return error("expected LEN(<string>)");
+    }
+    active_cg().emit_strlen(r, r);
+    set_str_reg(r, false);
+    *out_reg = r;
+    *end = s + 1;
+    return std::nullopt;
+}
 
-    while (*p == '+' || *p == '-') {
-        char op = *p++;
-        p = skip_ws(p);
-        int rreg;
-        if (auto err = emit_mul_expr(p, &p, &rreg)) {
-            ralloc_release(lreg);
+// MID(s, start[, len]): len bytes of s from the 1-based start, or the rest of s
+std::optional<std::string> Parser::emit_mid(const char* s, const char** end, int* out_reg) {
+    int str_reg;
+    if (auto err = emit_expr_p(s, &s, &str_reg)) {
+        return err;
+    }
+    if (!is_str_reg(str_reg)) {
+        ralloc_release(str_reg);
+        return error("MID expects a string as its first argument");
+    }
+    s = skip_ws(s);
+    if (*s != ',') {
+        ralloc_release(str_reg);
+        return error("expected MID(<string>, <start>[, <length>])");
+    }
+    int start_reg;
+    if (auto err = emit_expr_p(s + 1, &s, &start_reg)) {
+        ralloc_release(str_reg);
+        return err;
+    }
+    s = skip_ws(s);
+    int len_reg;
+    if (*s == ',') {
+        if (auto err = emit_expr_p(s + 1, &s, &len_reg)) {
+            ralloc_release(str_reg);
+            ralloc_release(start_reg);
             return err;
         }
-        p = skip_ws(p);
-        if (op == '+') {
-            active_cg().emit_add(lreg, rreg);
-        } else {
-            active_cg().emit_sub(lreg, rreg);
+        s = skip_ws(s);
+    } else {
+        len_reg = ralloc_acquire();
+        if (len_reg < 0) {
+            ralloc_release(str_reg);
+            ralloc_release(start_reg);
+            return error("out of scratch registers");
         }
-        ralloc_release(rreg);
+        active_cg().emit_movi(len_reg, -1);
     }
-    *end = p;
-    *out_reg = lreg;
+    if (*s != ')') {
+        ralloc_release(str_reg);
+        ralloc_release(start_reg);
+        ralloc_release(len_reg);
+        return error("expected ')' after MID arguments");
+    }
+
+    active_cg().emit_dec(start_reg);
+    active_cg().emit_substr(str_reg, str_reg, start_reg, len_reg);
+    ralloc_release(start_reg);
+    ralloc_release(len_reg);
+    *out_reg = str_reg;
+    *end = s + 1;
+    return std::nullopt;
+}
+
+// STR(n) and HEX(n): n written in decimal or lowercase hex
+std::optional<std::string> Parser::emit_to_string(const char* s, const char** end, int* out_reg,
+                                                  int base) {
+    const char* name = base == 16 ? "HEX" : "STR";
+    int r;
+    if (auto err = emit_expr_p(s, &s, &r)) {
+        return err;
+    }
+    s = skip_ws(s);
+    if (*s != ')' || is_str_reg(r)) {
+        ralloc_release(r);
+        return error(std::format("expected {}(<integer>)", name));
+    }
+    active_cg().emit_itoa(r, r, base);
+    set_str_reg(r, true);
+    *out_reg = r;
+    *end = s + 1;
+    return std::nullopt;
+}
+
+// VAL(s): the decimal integer s holds, or 0 when it is not one
+std::optional<std::string> Parser::emit_val(const char* s, const char** end, int* out_reg) {
+    int r;
+    if (auto err = emit_expr_p(s, &s, &r)) {
+        return err;
+    }
+    s = skip_ws(s);
+    if (*s != ')' || !is_str_reg(r)) {
+        ralloc_release(r);
+        return error("expected VAL(<string>)");
+    }
+    active_cg().emit_atoi(r, r);
+    set_str_reg(r, false);
+    *out_reg = r;
+    *end = s + 1;
+    return std::nullopt;
+}
+
+// FORMAT(template, args...): fills the template's {} placeholders in one STRFMT
+std::optional<std::string> Parser::emit_format(const char* s, const char** end, int* out_reg) {
+    int tmpl_reg;
+    if (auto err = emit_expr_p(s, &s, &tmpl_reg)) {
+        return err;
+    }
+    std::vector<int> args;
+    auto release_all = [&] {
+        ralloc_release(tmpl_reg);
+        for (int a : args) {
+            ralloc_release(a);
+        }
+    };
+    if (!is_str_reg(tmpl_reg)) {
+        release_all();
+        return error("FORMAT expects a string template as its first argument");
+    }
+    s = skip_ws(s);
+    while (*s == ',') {
+        int arg_reg;
+        if (auto err = emit_expr_p(s + 1, &s, &arg_reg)) {
+            release_all();
+            return err;
+        }
+        args.push_back(arg_reg);
+        s = skip_ws(s);
+    }
+    if (*s != ')') {
+        release_all();
+        return error("expected ')' after FORMAT arguments");
+    }
+
+    active_cg().emit_strfmt(tmpl_reg, tmpl_reg, args);
+    for (int a : args) {
+        ralloc_release(a);
+    }
+    *out_reg = tmpl_reg;
+    *end = s + 1;
     return std::nullopt;
 }
 
@@ -423,6 +763,17 @@ std::optional<std::string> Parser::emit_condition(const char* s, const std::stri
             return err;
         }
 
+        // strings compare by content: fold to STRCMP's sign and compare that with zero
+        if (is_str_reg(lreg) || is_str_reg(rreg)) {
+            if (!is_str_reg(lreg) || !is_str_reg(rreg)) {
+                ralloc_release(lreg);
+                ralloc_release(rreg);
+                return error("cannot compare a string with an integer");
+            }
+            active_cg().emit_strcmp(lreg, lreg, rreg);
+            active_cg().emit_movi(rreg, 0);
+        }
+
         bool flip = (op == ">" || op == "<=");
         active_cg().emit_cmp(flip ? rreg : lreg, flip ? lreg : rreg);
 
@@ -454,82 +805,60 @@ std::optional<std::string> Parser::emit_condition(const char* s, const std::stri
     return std::nullopt;
 }
 
+// evaluates exactly regs.size() comma-separated expressions, left to right
+std::optional<std::string> Parser::emit_expr_list(const char* s, std::span<int> regs,
+                                                  std::string_view stmt_name) {
+    const char* p = s;
+    size_t done = 0;
+    auto fail = [&](std::optional<std::string> err) {
+        for (size_t i = 0; i < done; i++) {
+            ralloc_release(regs[i]);
+        }
+        return err;
+    };
+    for (; done < regs.size(); done++) {
+        if (done > 0) {
+            p = skip_ws(p);
+            if (*p != ',') {
+                return fail(error(std::format("{} expects {} arguments", stmt_name, regs.size())));
+            }
+            p++;
+        }
+        if (auto err = emit_expr_p(p, &p, &regs[done])) {
+            return fail(err);
+        }
+    }
+    if (*skip_ws(p) != '\0') {
+        return fail(error(std::format("{} expects {} arguments", stmt_name, regs.size())));
+    }
+    return std::nullopt;
+}
+
 std::optional<std::string> Parser::emit_write_values(const char* arg, std::string_view stmt_name,
                                                      bool to_stderr) {
     while (*arg) {
         arg = skip_ws(arg);
 
-        // check if it's an identifier that names a string var
-        if (isalpha(static_cast<unsigned char>(*arg)) || *arg == '_') {
-            std::string name;
-            const char* p = arg;
-            while (*p && (isalnum(static_cast<unsigned char>(*p)) || *p == '_')) {
-                name += *p++;
-            }
-            const char* after = skip_ws(p);
-            if (*after == '\0' || *after == ',') {
-                Variable* v = active_scope().find(name);
-                if (v && v->type == VarType::Str) {
-                    int r = ralloc_acquire();
-                    if (r < 0) {
-                        return error("out of scratch registers");
-                    }
-                    if (v->is_const) {
-                        active_cg().emit_load_str(r, v->data_name);
-                    } else if (v->is_global) {
-                        active_cg().emit_load_global(r, v->name, v->name);
-                    } else {
-                        active_cg().emit_load_var(r, v->slot, v->name);
-                    }
-                    if (to_stderr) {
-                        active_cg().emit_eprint_str(r);
-                    } else {
-                        active_cg().emit_print_str(r);
-                    }
-                    ralloc_release(r);
-                    arg = after;
-                    goto next_arg;
-                }
-            }
+        // string literal, string or numeric expression
+        const char* expr_end = nullptr;
+        int reg;
+        if (auto err = emit_expr_p(arg, &expr_end, &reg)) {
+            return err;
         }
-
-        // string literal
-        if (*arg == '"') {
-            const char* str_end = strchr(arg + 1, '"');
-            if (!str_end) {
-                return error(std::format("unterminated string in {}", stmt_name));
-            }
-            std::string dname = std::format("_p{}", uid_++);
-            active_cg().emit_data_str(dname, std::string(arg + 1, str_end - arg - 1));
-            int r = ralloc_acquire();
-            if (r < 0) {
-                return error("out of scratch registers");
-            }
-            active_cg().emit_load_str(r, dname);
+        if (is_str_reg(reg)) {
             if (to_stderr) {
-                active_cg().emit_eprint_str(r);
+                active_cg().emit_eprint_str(reg);
             } else {
-                active_cg().emit_print_str(r);
+                active_cg().emit_print_str(reg);
             }
-            ralloc_release(r);
-            arg = skip_ws(str_end + 1);
+        } else if (to_stderr) {
+            active_cg().emit_eprint_reg(reg);
         } else {
-            // numeric expression
-            const char* expr_end = nullptr;
-            int reg;
-            if (auto err = emit_expr_p(arg, &expr_end, &reg)) {
-                return err;
-            }
-            if (to_stderr) {
-                active_cg().emit_eprint_reg(reg);
-            } else {
-                active_cg().emit_print_reg(reg);
-            }
-            ralloc_release(reg);
-            arg = skip_ws(expr_end);
+            active_cg().emit_print_reg(reg);
         }
+        ralloc_release(reg);
+        arg = skip_ws(expr_end);
 
-    next_arg:
         if (*arg == ',') {
             arg = skip_ws(arg + 1);
             if (*arg == '\0') {
@@ -16,6 +16,7 @@ RegGuard::RegGuard(RegAlloc& ra) : ra(ra) {
     for (int i = 0; i < SCRATCH_COUNT; i++) {
         if (!(ra.used & (1u << i))) {
             ra.used |= (1u << i);
+            ra.strings &= ~(1u << i);
             reg = SCRATCH_MIN + i;
             return;
         }
@@ -114,6 +115,7 @@ int Parser::ralloc_acquire() {
     for (int i = 0; i < SCRATCH_COUNT; i++) {
         if (!(ra_.used & (1u << i))) {
             ra_.used |= (1u << i);
+            ra_.strings &= ~(1u << i);
             return SCRATCH_MIN + i;
         }
     }
@@ -125,6 +127,16 @@ void Parser::ralloc_release(int reg) {
     }
 }
 
+bool Parser::is_str_reg(int reg) const {
+    return reg >= SCRATCH_MIN && reg <= SCRATCH_MAX && (ra_.strings & (1u << (reg - SCRATCH_MIN)));
+}
+void Parser::set_str_reg(int reg, bool is_str) {
+    if (reg >= SCRATCH_MIN && reg <= SCRATCH_MAX) {
+        uint32_t bit = 1u << (reg - SCRATCH_MIN);
+        ra_.strings = is_str ? (ra_.strings | bit) : (ra_.strings & ~bit);
+    }
+}
+
 Block* Parser::find_loop_block() {
     for (int i = static_cast<int>(block_stack_.size()) - 1; i >= 0; i--) {
         if (block_stack_[i].kind == BlockKind::While || block_stack_[i].kind == BlockKind::For) {
@@ -577,6 +589,9 @@ std::optional<std::string> Parser::compile_line(const std::string& s) {
     if (starts_with_ci(s, "VAR ")) {
         return stmt_var(s, false);
     }
+    if (starts_with_ci(s, "BYTE ARRAY ")) {
+        return stmt_array(trim(s.substr(11)), true);
+    }
 
     if (starts_with_ci(s, "IF ")) {
         return stmt_if(s);
@@ -674,6 +689,9 @@ std::optional<std::string> Parser::compile_line(const std::string& s) {
     if (starts_with_ci(s, "FSEEK")) {
         return stmt_fseek(s);
     }
+    if (starts_with_ci(s, "FCOPY ")) {
+        return stmt_fcopy(s);
+    }
     if (starts_with_ci(s, "FPRINT")) {
         return stmt_fprint(s);
     }
@@ -693,6 +711,18 @@ std::optional<std::string> Parser::compile_line(const std::string& s) {
     if (equals_ci(s, "CLRSCR")) {
         return stmt_clrscr();
     }
+    if (starts_with_ci(s, "SCRINIT ")) {
+        return stmt_scrinit(s);
+    }
+    if (starts_with_ci(s, "SCRPUT ")) {
+        return stmt_scrput(s);
+    }
+    if (starts_with_ci(s, "SCRBLIT ")) {
+        return stmt_scrblit(s);
+    }
+    if (equals_ci(s, "SCRFLUSH")) {
+        return stmt_scrflush();
+    }
     if (starts_with_ci(s, "FOREACH")) {
         return stmt_foreach(s);
     }
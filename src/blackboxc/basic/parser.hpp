@@ -9,6 +9,7 @@
 #include "types.hpp"
 #include <filesystem>
 #include <optional>
+#include <span>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -103,6 +104,7 @@ class Parser {
     std::optional<std::string> compile_line(const std::string& s);
 
     std::optional<std::string> stmt_var(const std::string& s, bool is_global);
+    std::optional<std::string> stmt_array(const std::string& body, bool bytes);
     std::optional<std::string> stmt_const(const std::string& s);
     std::optional<std::string> stmt_assign(const std::string& s);
     std::optional<std::string> stmt_if(const std::string& s);
@@ -112,6 +114,8 @@ class Parser {
     std::optional<std::string> stmt_while(const std::string& s);
     std::optional<std::string> stmt_endwhile();
     std::optional<std::string> stmt_for(const std::string& s);
+    std::optional<std::string> emit_counted_for(const Variable* v, const std::string& var_name,
+                                                int32_t step, const std::string& limit_expr);
     std::optional<std::string> stmt_foreach(const std::string& s);
     std::optional<std::string> stmt_next(const std::string& s);
     std::optional<std::string> stmt_print(const std::string& s, bool to_stderr);
@@ -134,25 +138,53 @@ class Parser {
     std::optional<std::string> stmt_fread(const std::string& s);
     std::optional<std::string> stmt_fwrite(const std::string& s);
     std::optional<std::string> stmt_fseek(const std::string& s);
+    std::optional<std::string> stmt_fcopy(const std::string& s);
     std::optional<std::string> stmt_fprint(const std::string& s);
     std::optional<std::string> stmt_getarg(const std::string& s);
     std::optional<std::string> stmt_getargc(const std::string& s);
     std::optional<std::string> stmt_getenv(const std::string& s);
     std::optional<std::string> stmt_getkey(const std::string& s);
     std::optional<std::string> stmt_clrscr();
+    std::optional<std::string> stmt_scrinit(const std::string& s);
+    std::optional<std::string> stmt_scrput(const std::string& s);
+    std::optional<std::string> stmt_scrblit(const std::string& s);
+    std::optional<std::string> stmt_scrflush();
 
+    Variable* find_variable(const std::string& name);
     std::optional<std::string> emit_atom(const char* s, const char** end, int* out_reg);
     std::optional<std::string> emit_unary(const char* s, const char** end, int* out_reg);
     std::optional<std::string> emit_bitwise(const char* s, const char** end, int* out_reg);
     std::optional<std::string> emit_mul_expr(const char* s, const char** end, int* out_reg);
     std::optional<std::string> emit_expr(const char* s, int* out_reg);
     std::optional<std::string> emit_expr_p(const char* s, const char** end, int* out_reg);
+    std::optional<std::string> emit_additive(char op, int* lreg, const Value& lhs,
+                                             const Value& rhs);
+    // binding level of a binary operator, loosest last
+    enum class OpLevel { Bitwise, Mul, Add };
+    std::optional<Value> fold_operand(const char* s, const char** end, OpLevel level);
+    std::optional<std::string> emit_operand(const char* s, const char** end, OpLevel level,
+                                            Value* out);
+    std::optional<std::string> emit_lhs(const char* s, const char** end, OpLevel level, int* lreg,
+                                        Value* lhs);
+    std::optional<std::string> emit_fold_binop(BinOp op, int* lreg, const Value& lhs,
+                                               const Value& rhs);
+    std::optional<std::string> emit_len(const char* s, const char** end, int* out_reg);
+    std::optional<std::string> emit_mid(const char* s, const char** end, int* out_reg);
+    std::optional<std::string> emit_to_string(const char* s, const char** end, int* out_reg,
+                                              int base);
+    std::optional<std::string> emit_val(const char* s, const char** end, int* out_reg);
+    std::optional<std::string> emit_format(const char* s, const char** end, int* out_reg);
     std::optional<std::string> emit_condition(const char* s, const std::string& skip_label);
+    std::optional<std::string> emit_expr_list(const char* s, std::span<int> regs,
+                                              std::string_view stmt_name);
     std::optional<std::string> emit_write_values(const char* arg, std::string_view stmt_name,
                                                  bool to_stderr);
 
     int ralloc_acquire();
     void ralloc_release(int reg);
+    // expressions are untyped registers; this tracks which scratch registers hold strings
+    bool is_str_reg(int reg) const;
+    void set_str_reg(int reg, bool is_str);
     std::string reg_name(int r) const;
     std::string make_label(std::string_view prefix);
     std::string error(std::string_view msg) const;
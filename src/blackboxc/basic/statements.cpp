@@ -2,12 +2,31 @@
 // Created by User on 2026-04-22.
 //
 #include "parser.hpp"
+#include <array>
 #include <cctype>
+#include <cstdlib>
 #include <cstring>
 #include <format>
 #include <print>
 
 namespace basic {
+namespace {
+// exactly one "..." literal, as opposed to an expression that starts with one
+bool is_string_literal(std::string_view rhs) {
+    return rhs.size() >= 2 && rhs.front() == '"' && rhs.find('"', 1) == rhs.size() - 1;
+}
+
+// the value of a lone integer literal such as "2" or "-1", as opposed to an expression
+std::optional<int32_t> int_literal(const std::string& s) {
+    char* endptr;
+    long long v = strtoll(s.c_str(), &endptr, 10);
+    if (endptr == s.c_str() || *endptr != '\0' || v < INT32_MIN || v > INT32_MAX) {
+        return std::nullopt;
+    }
+    return static_cast<int32_t>(v);
+}
+} // namespace
+
 std::optional<std::string> Parser::stmt_var(const std::string& s, bool is_global) {
     std::string body = s;
 
@@ -16,32 +35,8 @@ std::optional<std::string> Parser::stmt_var(const std::string& s, bool is_global
     }
 
     // array
-    size_t start_bracket = body.find('[');
-    if (start_bracket != std::string::npos) {
-        std::string array_name = trim(body.substr(0, start_bracket));
-        size_t close_bracket = body.find(']', start_bracket + 1);
-        if (close_bracket == std::string::npos) {
-            return error("expected ']' in array declaration");
-        }
-        std::string size_str =
-            trim(body.substr(start_bracket + 1, close_bracket - start_bracket - 1));
-        char* endptr;
-        long size = strtol(size_str.c_str(), &endptr, 10);
-
-        if (*endptr != '\0' || size <= 0) {
-            return error(std::format("invalid array size '{}'", size_str));
-        }
-
-        if (array_name.empty()) {
-            return error("expected array name");
-        }
-        if (arrays_.count(array_name)) {
-            return error(std::format("array '{}' already declared", array_name));
-        }
-        arrays_[array_name] = ArrayInfo{heap_top_, static_cast<size_t>(size)};
-        heap_top_ += static_cast<size_t>(size);
-        active_cg().emit_grow(static_cast<int>(size));
-        return std::nullopt;
+    if (body.find('[') != std::string::npos) {
+        return stmt_array(body, false);
     }
 
     size_t eq = body.find('=');
@@ -55,7 +50,7 @@ std::optional<std::string> Parser::stmt_var(const std::string& s, bool is_global
         return error("expected variable name");
     }
 
-    if (!rhs.empty() && rhs[0] == '"') {
+    if (is_string_literal(rhs)) {
         // string var
         const char* str_start = rhs.c_str() + 1;
         const char* str_end = strchr(str_start, '"');
@@ -84,16 +79,17 @@ std::optional<std::string> Parser::stmt_var(const std::string& s, bool is_global
             std::println("[BASIC] VAR string {} -> ${}", name, dname);
         }
     } else {
-        // integer var
+        // integer var, or a string var initialised from a string expression
         if (active_scope().find(name) && !is_global) {
             return error(std::format("variable '{}' already defined", name));
         }
 
-        Variable* v = active_scope().add_int(name, is_global);
         int ereg;
         if (auto err = emit_expr(rhs.c_str(), &ereg)) {
             return err;
         }
+        Variable* v = is_str_reg(ereg) ? active_scope().add_str(name, "", false, is_global)
+                                       : active_scope().add_int(name, is_global);
         if (is_global) {
             active_cg().emit_store_global(ereg, v->name, name);
         } else {
@@ -102,13 +98,46 @@ std::optional<std::string> Parser::stmt_var(const std::string& s, bool is_global
         ralloc_release(ereg);
 
         if (debug_) {
-            std::println("[BASIC] VAR int {} -> slot {}", name, v->slot);
+            std::println("[BASIC] VAR {} {} -> slot {}",
+                         v->type == VarType::Str ? "string" : "int", name, v->slot);
         }
     }
 
     return std::nullopt;
 }
 
+// name[size]; a BYTE ARRAY packs eight elements into each heap slot
+std::optional<std::string> Parser::stmt_array(const std::string& body, bool bytes) {
+    size_t start_bracket = body.find('[');
+    if (start_bracket == std::string::npos) {
+        return error("expected BYTE ARRAY <name>[<size>]");
+    }
+    std::string array_name = trim(body.substr(0, start_bracket));
+    size_t close_bracket = body.find(']', start_bracket + 1);
+    if (close_bracket == std::string::npos) {
+        return error("expected ']' in array declaration");
+    }
+    std::string size_str = trim(body.substr(start_bracket + 1, close_bracket - start_bracket - 1));
+    char* endptr;
+    long size = strtol(size_str.c_str(), &endptr, 10);
+
+    if (*endptr != '\0' || size <= 0) {
+        return error(std::format("invalid array size '{}'", size_str));
+    }
+
+    if (array_name.empty()) {
+        return error("expected array name");
+    }
+    if (arrays_.count(array_name)) {
+        return error(std::format("array '{}' already declared", array_name));
+    }
+    size_t slots = bytes ? (static_cast<size_t>(size) + 7) / 8 : static_cast<size_t>(size);
+    arrays_[array_name] = ArrayInfo{heap_top_, static_cast<size_t>(size), bytes};
+    heap_top_ += slots;
+    active_cg().emit_grow(static_cast<int>(slots));
+    return std::nullopt;
+}
+
 std::optional<std::string> Parser::stmt_const(const std::string& s) {
     std::string body = s;
     if (starts_with_ci(body, "CONST ")) {
@@ -186,18 +215,25 @@ std::optional<std::string> Parser::stmt_assign(const std::string& s) {
                 return err;
             }
 
-            int addr_reg = ralloc_acquire();
-            active_cg().emit_movi(addr_reg, static_cast<int32_t>(array_info.base));
-            active_cg().emit_add(addr_reg, idx_reg);
-            ralloc_release(idx_reg);
+            if (array_info.bytes) {
+                int val_reg;
+                if (auto err = emit_expr(right.c_str(), &val_reg)) {
+                    ralloc_release(idx_reg);
+                    return err;
+                }
+                active_cg().emit_store_byte(array_info.base, idx_reg, val_reg);
+                ralloc_release(idx_reg);
+                ralloc_release(val_reg);
+                return std::nullopt;
+            }
 
             int val_reg;
             if (auto err = emit_expr(right.c_str(), &val_reg)) {
-                ralloc_release(addr_reg);
+                ralloc_release(idx_reg);
                 return err;
             }
-            active_cg().emit_heap_write(addr_reg, val_reg);
-            ralloc_release(addr_reg);
+            active_cg().emit_heap_write(array_info.base, idx_reg, val_reg);
+            ralloc_release(idx_reg);
             ralloc_release(val_reg);
             return std::nullopt;
         }
@@ -228,10 +264,7 @@ std::optional<std::string> Parser::stmt_assign(const std::string& s) {
 
     std::string rhs = trim(s.substr(eq + 1));
 
-    if (v->type == VarType::Str) {
-        if (rhs.empty() || rhs[0] != '"') {
-            return error(std::format("expected string literal for '{}'", name));
-        }
+    if (v->type == VarType::Str && is_string_literal(rhs)) {
         const char* str_start = rhs.c_str() + 1;
         const char* str_end = strchr(str_start, '"');
         if (!str_end) {
@@ -264,6 +297,13 @@ std::optional<std::string> Parser::stmt_assign(const std::string& s) {
     if (auto err = emit_expr(rhs.c_str(), &ereg)) {
         return err;
     }
+    if ((v->type == VarType::Str) != is_str_reg(ereg)) {
+        ralloc_release(ereg);
+        if (v->type == VarType::Str) {
+            return error(std::format("expected string expression for '{}'", name));
+        }
+        return error(std::format("cannot assign a string to integer '{}'", name));
+    }
 
     if (v->is_ref) {
         int slot_r = ralloc_acquire();
@@ -488,9 +528,6 @@ std::optional<std::string> Parser::stmt_for(const std::string& s) {
         return error("FOR variable must be integer");
     }
 
-    uint32_t limit_slot = active_scope().alloc_local_slot();
-    uint32_t step_slot = active_scope().alloc_local_slot();
-
     {
         int r;
         if (auto err = emit_expr(init_expr.c_str(), &r)) {
@@ -499,6 +536,15 @@ std::optional<std::string> Parser::stmt_for(const std::string& s) {
         active_cg().emit_store_var(r, v->slot, var_name);
         ralloc_release(r);
     }
+
+    // with a constant step the direction is known up front, so the loop is tested once here and
+    // NEXT is a single LOOP instruction
+    if (auto step = int_literal(step_expr)) {
+        return emit_counted_for(v, var_name, *step, limit_expr);
+    }
+
+    uint32_t limit_slot = active_scope().alloc_local_slot();
+    uint32_t step_slot = active_scope().alloc_local_slot();
     {
         int r;
         if (auto err = emit_expr(limit_expr.c_str(), &r)) {
@@ -568,6 +614,59 @@ std::optional<std::string> Parser::stmt_for(const std::string& s) {
     return std::nullopt;
 }
 
+std::optional<std::string> Parser::emit_counted_for(const Variable* v, const std::string& var_name,
+                                                    int32_t step, const std::string& limit_expr) {
+    Block b;
+    b.kind = BlockKind::For;
+    b.loop_label = make_label("for_next");
+    b.end_label = make_label("endfor");
+    b.for_var_slot = v->slot;
+    b.for_var_name = var_name;
+    b.for_counted = true;
+    b.for_step = step;
+    b.for_body_label = make_label("for_body");
+
+    if (auto limit = int_literal(limit_expr)) {
+        b.for_limit = {Value::Kind::Imm, *limit, {}};
+    } else {
+        b.for_limit_slot = active_scope().alloc_local_slot();
+        b.for_limit = {Value::Kind::Local, static_cast<int32_t>(b.for_limit_slot), {}};
+        int r;
+        if (auto err = emit_expr(limit_expr.c_str(), &r)) {
+            return err;
+        }
+        active_cg().emit_store_var(r, b.for_limit_slot, "for-limit");
+        ralloc_release(r);
+    }
+
+    int var_r = ralloc_acquire();
+    int lim_r = ralloc_acquire();
+    if (var_r < 0 || lim_r < 0) {
+        return error("out of scratch registers");
+    }
+    active_cg().emit_load_var(var_r, v->slot, var_name);
+    if (b.for_limit.kind == Value::Kind::Imm) {
+        active_cg().emit_movi(lim_r, b.for_limit.num);
+    } else {
+        active_cg().emit_load_var(lim_r, b.for_limit_slot, "for-limit");
+    }
+    if (step >= 0) {
+        active_cg().emit_cmp(lim_r, var_r);
+    } else {
+        active_cg().emit_cmp(var_r, lim_r);
+    }
+    active_cg().emit_jl(b.end_label);
+    active_cg().emit_label(b.for_body_label);
+    ralloc_release(var_r);
+    ralloc_release(lim_r);
+
+    block_stack_.push_back(b);
+    if (debug_) {
+        std::println("[BASIC] FOR {}", var_name);
+    }
+    return std::nullopt;
+}
+
 std::optional<std::string> Parser::stmt_foreach(const std::string& s) {
     std::string body = trim(s.substr(7));
     if (!body.empty() && body.back() == ':') {
@@ -648,19 +747,17 @@ std::optional<std::string> Parser::stmt_foreach(const std::string& s) {
     active_cg().emit_cmp(idx_r, len_r);
     active_cg().emit_jge(b.end_label);
 
-    // addr = base + idx
-    int addr_r = ralloc_acquire();
-    active_cg().emit_movi(addr_r, static_cast<int32_t>(arr.base));
-    active_cg().emit_add(addr_r, idx_r);
-
     // load element
     int val_r = ralloc_acquire();
-    active_cg().emit_heap_read(val_r, addr_r);
+    if (arr.bytes) {
+        active_cg().emit_load_byte(val_r, arr.base, idx_r);
+    } else {
+        active_cg().emit_heap_read(val_r, arr.base, idx_r);
+    }
     active_cg().emit_store_var(val_r, v->slot, var_name);
 
     ralloc_release(idx_r);
     ralloc_release(len_r);
-    ralloc_release(addr_r);
     ralloc_release(val_r);
 
     block_stack_.push_back(b);
@@ -696,7 +793,11 @@ std::optional<std::string> Parser::stmt_next(const std::string& s) {
         return error("out of scratch registers");
     }
 
-    if (b.kind == BlockKind::For) {
+    if (b.kind == BlockKind::For && b.for_counted) {
+        active_cg().emit_label(b.loop_label);
+        active_cg().emit_loop(b.for_var_slot, b.for_step, b.for_limit, b.for_body_label);
+        active_cg().emit_label(b.end_label);
+    } else if (b.kind == BlockKind::For) {
         active_cg().emit_load_var(var_r, b.for_var_slot, b.for_var_name);
         active_cg().emit_load_var(step_r, b.for_step_slot, "for-step");
         active_cg().emit_add(var_r, step_r);
@@ -743,7 +844,7 @@ std::optional<std::string> Parser::stmt_continue() {
         return error("CONTINUE outside loop");
     }
 
-    if (target->kind == BlockKind::While) {
+    if (target->kind == BlockKind::While || target->for_counted) {
         active_cg().emit_jmp(target->loop_label);
     } else {
         int var_r = ralloc_acquire();
@@ -1372,6 +1473,58 @@ std::optional<std::string> Parser::stmt_fseek(const std::string& s) {
     return std::nullopt;
 }
 
+std::optional<std::string> Parser::stmt_fcopy(const std::string& s) {
+    std::string arg = trim(s.substr(5));
+    std::string upper = arg;
+    for (auto& c : upper) {
+        c = toupper(static_cast<unsigned char>(c));
+    }
+    size_t to_pos = upper.find(" TO ");
+    if (to_pos == std::string::npos) {
+        return error("expected FCOPY <handle> TO <handle>[, <count>]");
+    }
+    std::string src_name = trim(arg.substr(0, to_pos));
+    std::string rest = trim(arg.substr(to_pos + 4));
+    std::string dst_name = rest;
+    std::string count_expr;
+    size_t comma = rest.find(',');
+    if (comma != std::string::npos) {
+        dst_name = trim(rest.substr(0, comma));
+        count_expr = trim(rest.substr(comma + 1));
+    }
+
+    auto src = get_file_handle_fd(src_name);
+    if (!src) {
+        return error(std::format("undefined file handle '{}'", src_name));
+    }
+    auto dst = get_file_handle_fd(dst_name);
+    if (!dst) {
+        return error(std::format("undefined file handle '{}'", dst_name));
+    }
+
+    // without a count, copy everything up to end of file
+    int r;
+    if (count_expr.empty()) {
+        r = ralloc_acquire();
+        if (r < 0) {
+            return error("out of scratch registers");
+        }
+        active_cg().emit_movi(r, -1);
+    } else {
+        const char* end = nullptr;
+        if (auto err = emit_expr_p(count_expr.c_str(), &end, &r)) {
+            return err;
+        }
+    }
+    active_cg().emit_fcopy(*src, *dst, r);
+    ralloc_release(r);
+
+    if (debug_) {
+        std::println("[BASIC] FCOPY {} TO {}", src_name, dst_name);
+    }
+    return std::nullopt;
+}
+
 std::optional<std::string> Parser::stmt_fprint(const std::string& s) {
     std::string arg = trim(s.substr(6));
     size_t comma = arg.find(',');
@@ -1561,4 +1714,52 @@ std::optional<std::string> Parser::stmt_clrscr() {
     return std::nullopt;
 }
 
-} // namespace basic
\ No newline at end of file
+std::optional<std::string> Parser::stmt_scrinit(const std::string& s) {
+    std::array<int, 2> regs{};
+    if (auto err = emit_expr_list(s.c_str() + 7, regs, "SCRINIT")) {
+        return err;
+    }
+    active_cg().emit_scrinit(regs[0], regs[1]);
+    for (int r : regs) {
+        ralloc_release(r);
+    }
+    if (debug_) {
+        std::println("[BASIC] SCRINIT");
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> Parser::stmt_scrput(const std::string& s) {
+    std::array<int, 3> regs{};
+    if (auto err = emit_expr_list(s.c_str() + 6, regs, "SCRPUT")) {
+        return err;
+    }
+    active_cg().emit_scrput(regs[0], regs[1], regs[2]);
+    for (int r : regs) {
+        ralloc_release(r);
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> Parser::stmt_scrblit(const std::string& s) {
+    std::string name = trim(s.substr(7));
+    auto it = arrays_.find(name);
+    if (it == arrays_.end()) {
+        return error(std::format("SCRBLIT expects an array, got '{}'", name));
+    }
+    if (it->second.bytes) {
+        return error(std::format("SCRBLIT needs one slot per cell, not BYTE ARRAY '{}'", name));
+    }
+    active_cg().emit_scrblit(it->second.base);
+    if (debug_) {
+        std::println("[BASIC] SCRBLIT {}", name);
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> Parser::stmt_scrflush() {
+    active_cg().emit_scrflush();
+    return std::nullopt;
+}
+
+} // namespace basic
@@ -4,6 +4,7 @@
 
 #ifndef BLACKBOX_TYPES_HPP
 #define BLACKBOX_TYPES_HPP
+#include "codegen.hpp"
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -28,6 +29,7 @@ struct Variable {
 
 struct RegAlloc {
     uint32_t used = 0;
+    uint32_t strings = 0; // scratch registers currently holding a string handle
 };
 
 enum class BlockKind { If, While, For, ForEach };
@@ -44,6 +46,12 @@ struct Block {
     uint32_t for_limit_slot = 0;
     uint32_t for_step_slot = 0;
     std::string for_var_name;
+    // constant step: NEXT is a single LOOP at loop_label, which CONTINUE jumps to, back to
+    // for_body_label
+    bool for_counted = false;
+    int32_t for_step = 0;
+    Value for_limit;
+    std::string for_body_label;
 
     // FOREACH
     uint32_t foreach_idx_slot = 0;
@@ -61,6 +69,7 @@ struct FileHandle {
 struct ArrayInfo {
     size_t base = 0;
     size_t length = 0;
+    bool bytes = false; // BYTE ARRAY: eight elements packed into each heap slot
 };
 
 struct FuncDef;
@@ -36,6 +36,8 @@ size_t operand_encoded_size(Operand::Kind kind) {
             return 5;
         case Operand::Kind::VarReg:
             return 2;
+        case Operand::Kind::HeapIndexed:
+            return 8;
         default:
             return 0;
     }
@@ -93,6 +95,13 @@ template <typename Buf> void encode_operand(const Operand& op, Buf& out) {
             write_u8(out, static_cast<uint8_t>(OperandType::VarReg));
             write_u8(out, op.reg);
             break;
+        case Operand::Kind::HeapIndexed:
+            write_u8(out, static_cast<uint8_t>(OperandType::HeapIndexed));
+            write_u8(out, op.reg);
+            write_u8(out, op.index);
+            write_u8(out, op.scale);
+            write_i32(out, op.imm);
+            break;
     }
 }
 
@@ -240,6 +249,35 @@ std::optional<std::string_view> parse_quoted(std::string_view s, size_t& pos) {
     pos = end + 1;
     return s.substr(start, end - start);
 }
+// NOSHELL commands are split on whitespace at assembly time; single quotes group an argument.
+// arguments are stored NUL-separated
+static std::string split_args(std::string_view cmd) {
+    std::string out;
+    bool in_arg = false;
+    bool quoted = false;
+    for (char c : cmd) {
+        if (c == '\'') {
+            quoted = !quoted;
+            if (!in_arg) {
+                in_arg = true;
+            }
+            continue;
+        }
+        if (!quoted && (c == ' ' || c == '\t')) {
+            if (in_arg) {
+                out.push_back('\0');
+                in_arg = false;
+            }
+            continue;
+        }
+        out.push_back(c);
+        in_arg = true;
+    }
+    if (!in_arg && !out.empty()) {
+        out.pop_back();
+    }
+    return out;
+}
 // maybe jank
 static std::optional<int32_t> parse_i32(std::string_view s);
 static std::optional<int32_t> eval_expr(std::string_view s);
@@ -473,6 +511,11 @@ std::optional<int32_t> parse_i32(std::string_view s) {
         return val;
     }
 
+    // a bare word or an out-of-range number is not an expression either; eval_expr would hand it
+    // straight back here
+    if (s.find_first_of("+-*/%()") == std::string_view::npos) {
+        return std::nullopt;
+    }
     return eval_expr(s);
 }
 
@@ -607,9 +650,95 @@ static std::string_view strip_brackets(std::string_view s) {
     return s;
 }
 
+constexpr bool is_heap(Operand::Kind k) {
+    return k == Operand::Kind::HeapAddr || k == Operand::Kind::HeapReg ||
+           k == Operand::Kind::HeapIndexed;
+}
+
 constexpr bool is_writable(Operand::Kind k) {
     return k == Operand::Kind::Reg || k == Operand::Kind::Bss || k == Operand::Kind::Var ||
-           k == Operand::Kind::HeapAddr || k == Operand::Kind::HeapReg;
+           is_heap(k);
+}
+
+// [base + index*scale + disp], e.g. [R1 + R2*2 + 100], [R3 - 1] or [R2*8 + 64]. terms may come in
+// any order and a literal may carry its own sign; a lone register is the base, a second one or a
+// scaled one the index. nullopt when no term is a register, so the caller can fall back to a bss
+// name
+std::optional<std::expected<Operand, std::string>> parse_indexed(std::string_view inner) {
+    Operand op;
+    op.kind = Operand::Kind::HeapIndexed;
+    op.reg = NO_REGISTER;
+    op.index = NO_REGISTER;
+    int64_t disp = 0;
+    bool any_reg = false;
+
+    size_t pos = 0;
+    bool negative = false;
+    while (true) {
+        // each term may carry its own sign, so [R1 + -4] means the same as [R1 - 4]
+        if (size_t sign = inner.find_first_not_of(" \t", pos);
+            sign != std::string_view::npos && (inner[sign] == '+' || inner[sign] == '-')) {
+            negative ^= inner[sign] == '-';
+            pos = sign + 1;
+        }
+        size_t next = inner.find_first_of("+-", pos);
+        auto term = trim(inner.substr(pos, next == std::string_view::npos ? next : next - pos));
+        if (term.empty()) {
+            return std::unexpected(std::format("missing term in '[{}]'", inner));
+        }
+
+        std::string_view reg_tok = term;
+        std::optional<int32_t> scale;
+        if (size_t star = term.find('*'); star != std::string_view::npos) {
+            auto lhs = trim(term.substr(0, star));
+            auto rhs = trim(term.substr(star + 1));
+            bool reg_first = parse_register(lhs).has_value();
+            if (!reg_first && !parse_register(rhs)) {
+                return std::unexpected(std::format("scaled term '{}' needs a register", term));
+            }
+            reg_tok = reg_first ? lhs : rhs;
+            scale = parse_i32(reg_first ? rhs : lhs);
+            if (!scale || *scale < 1 || *scale > 255) {
+                return std::unexpected(std::format("scale in '{}' must be 1..255", term));
+            }
+        }
+
+        if (auto r = parse_register(reg_tok)) {
+            any_reg = true;
+            if (negative) {
+                return std::unexpected(std::format("register '{}' cannot be subtracted", term));
+            }
+            if (!scale && op.reg == NO_REGISTER) {
+                op.reg = *r;
+            } else if (op.index == NO_REGISTER) {
+                op.index = *r;
+                op.scale = static_cast<uint8_t>(scale.value_or(1));
+            } else {
+                return std::unexpected(std::format("too many registers in '[{}]'", inner));
+            }
+        } else if (auto v = parse_i32(term)) {
+            disp += negative ? -int64_t{*v} : int64_t{*v};
+        } else {
+            return std::nullopt;
+        }
+
+        if (next == std::string_view::npos) {
+            break;
+        }
+        negative = inner[next] == '-';
+        pos = next + 1;
+    }
+
+    if (!any_reg) {
+        return std::nullopt;
+    }
+    if (disp < std::numeric_limits<int32_t>::min() || disp > std::numeric_limits<int32_t>::max()) {
+        return std::unexpected(
+            std::format("displacement in '[{}]' does not fit in 32 bits", inner));
+    }
+    op.imm = static_cast<int32_t>(disp);
+    op.name = std::format("[{}]", inner);
+    return op;
 }
 
 } // namespace
@@ -640,11 +769,14 @@ std::expected<Operand, std::string> parse_operand(std::string_view tok, const Op
         return op;
     }
 
-    // BssDeref: [name]
+    // BssDeref: [name], or a scaled-index heap address: [base + index*scale + disp]
     if (tok.front() == '[' && tok.back() == ']') {
         auto name = trim(tok.substr(1, tok.size() - 2));
         auto it = ctx.bss_symbols.find(std::string(name));
         if (it == ctx.bss_symbols.end()) {
+            if (auto indexed = parse_indexed(name)) {
+                return *indexed;
+            }
             return std::unexpected(std::format("undefined bss symbol '{}'", name));
         }
         Operand op;
@@ -778,6 +910,25 @@ std::expected<void, std::string> encode(std::string_view line, const OperandCont
         return *f;
     };
 
+    auto need_value = [&](std::string_view tok,
+                          std::string_view what) -> std::expected<Operand, std::string> {
+        auto op = parse_operand(tok, ctx);
+        if (op && op->kind != Operand::Kind::Reg && op->kind != Operand::Kind::Imm) {
+            return std::unexpected(
+                std::format("{} must be register or immediate in '{}'", what, s));
+        }
+        return op;
+    };
+
+    auto need_heap = [&](std::string_view tok,
+                         std::string_view what) -> std::expected<Operand, std::string> {
+        auto op = parse_operand(tok, ctx);
+        if (op && !is_heap(op->kind)) {
+            return std::unexpected(std::format("{} must be a heap address in '{}'", what, s));
+        }
+        return op;
+    };
+
     auto need_label = [&](std::string_view name) -> std::expected<uint32_t, std::string> {
         auto addr = resolve_label(name, ctx.labels);
         if (!addr) {
@@ -1086,6 +1237,48 @@ std::expected<void, std::string> encode(std::string_view line, const OperandCont
         encode_operand(*src, out);
         return {};
     }
+    // three-operand arithmetic: dst = a op b, with any readable operand for a and b
+    struct ThreeOperand {
+        std::string_view name;
+        Opcode opcode;
+    };
+    static constexpr ThreeOperand three_operand[] = {
+        {"ADD3", Opcode::ADD3}, {"SUB3", Opcode::SUB3}, {"MUL3", Opcode::MUL3},
+        {"DIV3", Opcode::DIV3}, {"MOD3", Opcode::MOD3}, {"AND3", Opcode::AND3},
+        {"OR3", Opcode::OR3},   {"XOR3", Opcode::XOR3}, {"SHL3", Opcode::SHL3},
+        {"SHR3", Opcode::SHR3},
+    };
+    for (const ThreeOperand& t : three_operand) {
+        if (!starts_with_keyword(s, t.name)) {
+            continue;
+        }
+        auto [dst_tok, rest] = split_comma(after_keyword(s, t.name.size()));
+        auto [a_tok, b_tok] = split_comma(rest);
+        auto dst = parse_operand(dst_tok, ctx);
+        if (!dst) {
+            return std::unexpected(dst.error());
+        }
+        if (!is_writable(dst->kind)) {
+            return err(std::format("{} dst must be register, [bss], framevar or heap address",
+                                   t.name));
+        }
+        auto a = parse_operand(a_tok, ctx);
+        if (!a) {
+            return std::unexpected(a.error());
+        }
+        auto b = parse_operand(b_tok, ctx);
+        if (!b) {
+            return std::unexpected(b.error());
+        }
+        if (a->kind == Operand::Kind::FD || b->kind == Operand::Kind::FD) {
+            return err(std::format("{} operands cannot be file descriptors", t.name));
+        }
+        write_u8(out, opcode_to_byte(t.opcode));
+        encode_operand(*dst, out);
+        encode_operand(*a, out);
+        encode_operand(*b, out);
+        return {};
+    }
 
     if (starts_with_keyword(s, "MOV")) {
         auto [dst_tok, src_tok] = split_comma(after_keyword(s, 3));
@@ -1163,6 +1356,36 @@ std::expected<void, std::string> encode(std::string_view line, const OperandCont
         write_u32(out, addr);
         return {};
     }
+    if (starts_with_keyword(s, "LOOP")) {
+        auto [counter_tok, rest] = split_comma(after_keyword(s, 4));
+        auto [step_tok, rest2] = split_comma(rest);
+        auto [limit_tok, label_tok] = split_comma(rest2);
+        auto counter = parse_operand(counter_tok, ctx);
+        if (!counter) {
+            return std::unexpected(counter.error());
+        }
+        if (!is_writable(counter->kind)) {
+            return err("LOOP counter must be register, [bss], framevar or heap address");
+        }
+        auto step = need_value(step_tok, "LOOP step");
+        if (!step) {
+            return std::unexpected(step.error());
+        }
+        auto limit = parse_operand(limit_tok, ctx);
+        if (!limit) {
+            return std::unexpected(limit.error());
+        }
+        if (limit->kind == Operand::Kind::FD) {
+            return err("LOOP limit cannot be a file descriptor");
+        }
+        TRY_LABEL(addr, trim(label_tok))
+        write_u8(out, opcode_to_byte(Opcode::LOOP));
+        encode_operand(*counter, out);
+        encode_operand(*step, out);
+        encode_operand(*limit, out);
+        write_u32(out, addr);
+        return {};
+    }
     if (starts_with_keyword(s, "JNE")) {
         TRY_LABEL(addr, after_keyword(s, 3))
         write_u8(out, opcode_to_byte(Opcode::JNE));
@@ -1217,6 +1440,147 @@ std::expected<void, std::string> encode(std::string_view line, const OperandCont
         write_u32(out, frame_size);
         return {};
     }
+    if (starts_with_keyword(s, "COCREATE")) {
+        auto [reg_tok, label_tok] = split_comma(after_keyword(s, 8));
+        TRY_REG(r, reg_tok)
+        TRY_LABEL(addr, label_tok)
+        uint32_t frame_size = 0;
+        for (auto& l : ctx.labels) {
+            if (l.addr == addr) {
+                frame_size = l.frame_size;
+                break;
+            }
+        }
+        write_u8(out, opcode_to_byte(Opcode::COCREATE));
+        write_u8(out, r);
+        write_u32(out, addr);
+        write_u32(out, frame_size);
+        return {};
+    }
+    if (starts_with_keyword(s, "YIELD")) {
+        write_u8(out, opcode_to_byte(Opcode::YIELD));
+        return {};
+    }
+    if (starts_with_keyword(s, "RESUME")) {
+        TRY_REG(r, after_keyword(s, 6))
+        write_u8(out, opcode_to_byte(Opcode::RESUME));
+        write_u8(out, r);
+        return {};
+    }
+    if (starts_with_keyword(s, "CAS")) {
+        auto [addr_tok, rest] = split_comma(after_keyword(s, 3));
+        auto [exp_tok, desired_tok] = split_comma(rest);
+        auto addr = parse_operand(addr_tok, ctx);
+        if (!addr) {
+            return std::unexpected(addr.error());
+        }
+        if (!is_heap(addr->kind)) {
+            return err("CAS address must be a heap address");
+        }
+        TRY_REG(r, exp_tok)
+        auto desired = parse_operand(desired_tok, ctx);
+        if (!desired) {
+            return std::unexpected(desired.error());
+        }
+        write_u8(out, opcode_to_byte(Opcode::CAS));
+        encode_operand(*addr, out);
+        write_u8(out, r);
+        encode_operand(*desired, out);
+        return {};
+    }
+    if (starts_with_keyword(s, "FETCHADD")) {
+        auto [dst_tok, rest] = split_comma(after_keyword(s, 8));
+        auto [addr_tok, delta_tok] = split_comma(rest);
+        TRY_REG(r, dst_tok)
+        auto addr = parse_operand(addr_tok, ctx);
+        if (!addr) {
+            return std::unexpected(addr.error());
+        }
+        if (!is_heap(addr->kind)) {
+            return err("FETCHADD address must be a heap address");
+        }
+        auto delta = parse_operand(delta_tok, ctx);
+        if (!delta) {
+            return std::unexpected(delta.error());
+        }
+        write_u8(out, opcode_to_byte(Opcode::FETCHADD));
+        write_u8(out, r);
+        encode_operand(*addr, out);
+        encode_operand(*delta, out);
+        return {};
+    }
+    if (starts_with_keyword(s, "XCHG")) {
+        auto [reg_tok, addr_tok] = split_comma(after_keyword(s, 4));
+        TRY_REG(r, reg_tok)
+        auto addr = parse_operand(addr_tok, ctx);
+        if (!addr) {
+            return std::unexpected(addr.error());
+        }
+        if (!is_heap(addr->kind)) {
+            return err("XCHG address must be a heap address");
+        }
+        write_u8(out, opcode_to_byte(Opcode::XCHG));
+        write_u8(out, r);
+        encode_operand(*addr, out);
+        return {};
+    }
+    if (starts_with_keyword(s, "WAIT") || starts_with_keyword(s, "WAKE")) {
+        bool wait = starts_with_keyword(s, "WAIT");
+        auto [addr_tok, val_tok] = split_comma(after_keyword(s, 4));
+        auto addr = parse_operand(addr_tok, ctx);
+        if (!addr) {
+            return std::unexpected(addr.error());
+        }
+        if (!is_heap(addr->kind)) {
+            return err(wait ? "WAIT address must be a heap address"
+                            : "WAKE address must be a heap address");
+        }
+        auto val = parse_operand(val_tok, ctx);
+        if (!val) {
+            return std::unexpected(val.error());
+        }
+        write_u8(out, opcode_to_byte(wait ? Opcode::WAIT : Opcode::WAKE));
+        encode_operand(*addr, out);
+        encode_operand(*val, out);
+        return {};
+    }
+    if (starts_with_keyword(s, "CHSEND")) {
+        auto [chan_tok, rest] = split_comma(after_keyword(s, 6));
+        auto [val_tok, flag_tok] = split_comma(rest);
+        auto chan = parse_u32(chan_tok);
+        if (!chan || *chan >= MAX_CHANNELS) {
+            return err("invalid channel in CHSEND");
+        }
+        auto val = parse_operand(val_tok, ctx);
+        if (!val) {
+            return std::unexpected(val.error());
+        }
+        uint8_t flags = 0;
+        if (!flag_tok.empty()) {
+            if (flag_tok != "STR" && flag_tok != "str") {
+                return err("expected STR flag in CHSEND");
+            }
+            flags |= CHANNEL_STRING;
+        }
+        write_u8(out, opcode_to_byte(Opcode::CHSEND));
+        write_u8(out, static_cast<uint8_t>(*chan));
+        write_u8(out, flags);
+        encode_operand(*val, out);
+        return {};
+    }
+    if (starts_with_keyword(s, "CHRECV") || starts_with_keyword(s, "CHTRY")) {
+        bool recv = starts_with_keyword(s, "CHRECV");
+        auto [reg_tok, chan_tok] = split_comma(after_keyword(s, recv ? 6 : 5));
+        TRY_REG(r, reg_tok)
+        auto chan = parse_u32(chan_tok);
+        if (!chan || *chan >= MAX_CHANNELS) {
+            return err(recv ? "invalid channel in CHRECV" : "invalid channel in CHTRY");
+        }
+        write_u8(out, opcode_to_byte(recv ? Opcode::CHRECV : Opcode::CHTRY));
+        write_u8(out, r);
+        write_u8(out, static_cast<uint8_t>(*chan));
+        return {};
+    }
     if (starts_with_keyword(s, "RET")) {
         write_u8(out, opcode_to_byte(Opcode::RET));
         return {};
@@ -1291,8 +1655,33 @@ std::expected<void, std::string> encode(std::string_view line, const OperandCont
         write_u32(out, *v);
         return {};
     }
+    if (starts_with_keyword(s, "HALLOC")) {
+        auto [dst_tok, size_tok] = split_comma(after_keyword(s, 6));
+        TRY_REG(dst, dst_tok)
+        auto size = need_value(size_tok, "HALLOC size");
+        if (!size) {
+            return std::unexpected(size.error());
+        }
+        write_u8(out, opcode_to_byte(Opcode::HALLOC));
+        write_u8(out, dst);
+        encode_operand(*size, out);
+        return {};
+    }
+    if (starts_with_keyword(s, "HFREE")) {
+        auto addr = need_value(after_keyword(s, 5), "HFREE address");
+        if (!addr) {
+            return std::unexpected(addr.error());
+        }
+        write_u8(out, opcode_to_byte(Opcode::HFREE));
+        encode_operand(*addr, out);
+        return {};
+    }
     if (starts_with_keyword(s, "LOADSTR")) {
-        auto [reg_tok, name_tok] = split_comma(after_keyword(s, 7));
+        auto [name_tok, reg_tok] = split_comma(after_keyword(s, 7));
+        // documented as LOADSTR $name, reg; the reversed order is accepted too
+        if (parse_register(name_tok)) {
+            std::swap(name_tok, reg_tok);
+        }
         TRY_DATA(idx, name_tok)
         TRY_REG(r, reg_tok)
         write_u8(out, opcode_to_byte(Opcode::LOADSTR));
@@ -1312,6 +1701,189 @@ std::expected<void, std::string> encode(std::string_view line, const OperandCont
         write_u8(out, r);
         return {};
     }
+    if (starts_with_keyword(s, "STRCAT") || starts_with_keyword(s, "STRCMP")) {
+        bool cat = starts_with_keyword(s, "STRCAT");
+        auto [dst_tok, rest] = split_comma(after_keyword(s, 6));
+        auto [a_tok, b_tok] = split_comma(rest);
+        TRY_REG(dst, dst_tok)
+        TRY_REG(a, a_tok)
+        TRY_REG(b, b_tok)
+        write_u8(out, opcode_to_byte(cat ? Opcode::STRCAT : Opcode::STRCMP));
+        write_u8(out, dst);
+        write_u8(out, a);
+        write_u8(out, b);
+        return {};
+    }
+    if (starts_with_keyword(s, "STRLEN")) {
+        auto [dst_tok, src_tok] = split_comma(after_keyword(s, 6));
+        TRY_REG(dst, dst_tok)
+        TRY_REG(src, src_tok)
+        write_u8(out, opcode_to_byte(Opcode::STRLEN));
+        write_u8(out, dst);
+        write_u8(out, src);
+        return {};
+    }
+    if (starts_with_keyword(s, "SUBSTR")) {
+        auto [dst_tok, rest] = split_comma(after_keyword(s, 6));
+        auto [src_tok, rest2] = split_comma(rest);
+        auto [start_tok, len_tok] = split_comma(rest2);
+        TRY_REG(dst, dst_tok)
+        TRY_REG(src, src_tok)
+        auto start = need_value(start_tok, "SUBSTR start");
+        if (!start) {
+            return std::unexpected(start.error());
+        }
+        auto len = need_value(len_tok, "SUBSTR length");
+        if (!len) {
+            return std::unexpected(len.error());
+        }
+        write_u8(out, opcode_to_byte(Opcode::SUBSTR));
+        write_u8(out, dst);
+        write_u8(out, src);
+        encode_operand(*start, out);
+        encode_operand(*len, out);
+        return {};
+    }
+    if (starts_with_keyword(s, "CHARAT")) {
+        auto [dst_tok, rest] = split_comma(after_keyword(s, 6));
+        auto [src_tok, index_tok] = split_comma(rest);
+        TRY_REG(dst, dst_tok)
+        TRY_REG(src, src_tok)
+        auto index = need_value(index_tok, "CHARAT index");
+        if (!index) {
+            return std::unexpected(index.error());
+        }
+        write_u8(out, opcode_to_byte(Opcode::CHARAT));
+        write_u8(out, dst);
+        write_u8(out, src);
+        encode_operand(*index, out);
+        return {};
+    }
+    if (starts_with_keyword(s, "STRFROMHEAP")) {
+        auto [dst_tok, rest] = split_comma(after_keyword(s, 11));
+        auto [addr_tok, len_tok] = split_comma(rest);
+        TRY_REG(dst, dst_tok)
+        auto addr = parse_operand(addr_tok, ctx);
+        if (!addr) {
+            return std::unexpected(addr.error());
+        }
+        if (!is_heap(addr->kind)) {
+            return err("STRFROMHEAP base must be a heap address");
+        }
+        auto len = need_value(len_tok, "STRFROMHEAP length");
+        if (!len) {
+            return std::unexpected(len.error());
+        }
+        write_u8(out, opcode_to_byte(Opcode::STRFROMHEAP));
+        write_u8(out, dst);
+        encode_operand(*addr, out);
+        encode_operand(*len, out);
+        return {};
+    }
+    if (starts_with_keyword(s, "STRFIND") || starts_with_keyword(s, "STRCHR")) {
+        bool find = starts_with_keyword(s, "STRFIND");
+        const char* name = find ? "STRFIND" : "STRCHR";
+        auto [dst_tok, rest] = split_comma(after_keyword(s, find ? 7 : 6));
+        auto [src_tok, rest2] = split_comma(rest);
+        auto [what_tok, start_tok] = split_comma(rest2);
+        TRY_REG(dst, dst_tok)
+        TRY_REG(src, src_tok)
+        // the start offset is optional and defaults to 0
+        Operand start;
+        if (!start_tok.empty()) {
+            auto parsed = need_value(start_tok, std::format("{} start", name));
+            if (!parsed) {
+                return std::unexpected(parsed.error());
+            }
+            start = *parsed;
+        }
+        write_u8(out, opcode_to_byte(find ? Opcode::STRFIND : Opcode::STRCHR));
+        write_u8(out, dst);
+        write_u8(out, src);
+        if (find) {
+            TRY_REG(needle, what_tok)
+            write_u8(out, needle);
+        } else {
+            auto ch = need_value(what_tok, "STRCHR character");
+            if (!ch) {
+                return std::unexpected(ch.error());
+            }
+            encode_operand(*ch, out);
+        }
+        encode_operand(start, out);
+        return {};
+    }
+    if (starts_with_keyword(s, "ITOA") || starts_with_keyword(s, "ATOI")) {
+        bool itoa = starts_with_keyword(s, "ITOA");
+        const char* name = itoa ? "ITOA" : "ATOI";
+        auto [dst_tok, rest] = split_comma(after_keyword(s, 4));
+        auto [src_tok, base_tok] = split_comma(rest);
+        TRY_REG(dst, dst_tok)
+        TRY_REG(src, src_tok)
+        // the base is optional and defaults to 10
+        Operand base;
+        base.imm = 10;
+        if (!base_tok.empty()) {
+            auto parsed = need_value(base_tok, std::format("{} base", name));
+            if (!parsed) {
+                return std::unexpected(parsed.error());
+            }
+            base = *parsed;
+        }
+        write_u8(out, opcode_to_byte(itoa ? Opcode::ITOA : Opcode::ATOI));
+        write_u8(out, dst);
+        write_u8(out, src);
+        encode_operand(base, out);
+        return {};
+    }
+    if (starts_with_keyword(s, "STRFMT")) {
+        auto [dst_tok, rest] = split_comma(after_keyword(s, 6));
+        auto [tmpl_tok, args] = split_comma(rest);
+        TRY_REG(dst, dst_tok)
+        TRY_REG(tmpl, tmpl_tok)
+        std::vector<uint8_t> arg_regs;
+        while (!args.empty()) {
+            auto [arg_tok, more] = split_comma(args);
+            TRY_REG(arg, arg_tok)
+            if (arg_regs.size() == UINT8_MAX) {
+                return err("STRFMT takes at most 255 arguments");
+            }
+            arg_regs.push_back(arg);
+            args = more;
+        }
+        write_u8(out, opcode_to_byte(Opcode::STRFMT));
+        write_u8(out, dst);
+        write_u8(out, tmpl);
+        write_u8(out, static_cast<uint8_t>(arg_regs.size()));
+        for (uint8_t r : arg_regs) {
+            write_u8(out, r);
+        }
+        return {};
+    }
+    if (starts_with_keyword(s, "STRSPLIT")) {
+        auto [dst_tok, rest] = split_comma(after_keyword(s, 8));
+        auto [src_tok, rest2] = split_comma(rest);
+        auto [delim_tok, rest3] = split_comma(rest2);
+        auto [addr_tok, max_tok] = split_comma(rest3);
+        TRY_REG(dst, dst_tok)
+        TRY_REG(src, src_tok)
+        TRY_REG(delim, delim_tok)
+        auto addr = need_heap(addr_tok, "STRSPLIT destination");
+        if (!addr) {
+            return std::unexpected(addr.error());
+        }
+        auto max = need_value(max_tok, "STRSPLIT count");
+        if (!max) {
+            return std::unexpected(max.error());
+        }
+        write_u8(out, opcode_to_byte(Opcode::STRSPLIT));
+        write_u8(out, dst);
+        write_u8(out, src);
+        write_u8(out, delim);
+        encode_operand(*addr, out);
+        encode_operand(*max, out);
+        return {};
+    }
 
     if (starts_with_keyword(s, "WRITE")) {
         auto rest = after_keyword(s, 5);
@@ -1414,6 +1986,15 @@ std::expected<void, std::string> encode(std::string_view line, const OperandCont
         if (fname->size() > static_cast<size_t>(std::numeric_limits<uint32_t>::max())) {
             return err("filename too long in FOPEN");
         }
+        auto flag_tok = trim(rest3.substr(pos));
+        bool nonblocking = false;
+        if (!flag_tok.empty()) {
+            flag_tok = trim(flag_tok.substr(flag_tok[0] == ',' ? 1 : 0));
+            if (flag_tok != "NONBLOCK" && flag_tok != "nonblock") {
+                return err("expected NONBLOCK flag in FOPEN");
+            }
+            nonblocking = true;
+        }
 
         uint8_t mode_byte = 0;
         if (mode_tok == "r" || mode_tok == "R") {
@@ -1426,6 +2007,10 @@ std::expected<void, std::string> encode(std::string_view line, const OperandCont
             return err("invalid mode in FOPEN");
         }
 
+        if (nonblocking) {
+            mode_byte |= FD_NONBLOCK;
+        }
+
         write_u8(out, opcode_to_byte(Opcode::FOPEN));
         write_u8(out, mode_byte);
         write_u8(out, fd);
@@ -1441,28 +2026,116 @@ std::expected<void, std::string> encode(std::string_view line, const OperandCont
         write_u8(out, fd);
         return {};
     }
-    if (starts_with_keyword(s, "FREAD")) {
-        auto [fd_tok, reg_tok] = split_comma(after_keyword(s, 5));
-        TRY_FD(fd, fd_tok) TRY_REG(r, reg_tok) write_u8(out, opcode_to_byte(Opcode::FREAD));
+    if (starts_with_keyword(s, "FREAD") || starts_with_keyword(s, "FREADNB")) {
+        bool nb = starts_with_keyword(s, "FREADNB");
+        auto [fd_tok, reg_tok] = split_comma(after_keyword(s, nb ? 7 : 5));
+        TRY_FD(fd, fd_tok)
+        TRY_REG(r, reg_tok)
+        write_u8(out, opcode_to_byte(nb ? Opcode::FREADNB : Opcode::FREAD));
         write_u8(out, fd);
         write_u8(out, r);
         return {};
     }
-    if (starts_with_keyword(s, "FWRITE")) {
-        auto [fd_tok, val_tok] = split_comma(after_keyword(s, 6));
+    if (starts_with_keyword(s, "FWRITE") || starts_with_keyword(s, "FWRITENB")) {
+        bool nb = starts_with_keyword(s, "FWRITENB");
+        auto [fd_tok, val_tok] = split_comma(after_keyword(s, nb ? 8 : 6));
         TRY_FD(fd, fd_tok)
         auto src = parse_operand(val_tok, ctx);
         if (!src) {
             return std::unexpected(src.error());
         }
         if (src->kind != Operand::Kind::Reg && src->kind != Operand::Kind::Imm) {
-            return err("FWRITE value must be register or immediate");
+            return err(nb ? "FWRITENB value must be register or immediate"
+                          : "FWRITE value must be register or immediate");
         }
-        write_u8(out, opcode_to_byte(Opcode::FWRITE));
+        write_u8(out, opcode_to_byte(nb ? Opcode::FWRITENB : Opcode::FWRITE));
         write_u8(out, fd);
         encode_operand(*src, out);
         return {};
     }
+    if (starts_with_keyword(s, "FCOPY")) {
+        auto [src_tok, rest] = split_comma(after_keyword(s, 5));
+        auto [dst_tok, reg_tok] = split_comma(rest);
+        TRY_FD(src, src_tok)
+        TRY_FD(dst, dst_tok)
+        TRY_REG(r, reg_tok)
+        write_u8(out, opcode_to_byte(Opcode::FCOPY));
+        write_u8(out, src);
+        write_u8(out, dst);
+        write_u8(out, r);
+        return {};
+    }
+    if (starts_with_keyword(s, "FMAP")) {
+        auto [fd_tok, rest] = split_comma(after_keyword(s, 4));
+        auto [base_tok, len_tok] = split_comma(rest);
+        TRY_FD(fd, fd_tok)
+        TRY_REG(base, base_tok)
+        TRY_REG(len, len_tok)
+        write_u8(out, opcode_to_byte(Opcode::FMAP));
+        write_u8(out, fd);
+        write_u8(out, base);
+        write_u8(out, len);
+        return {};
+    }
+    if (starts_with_keyword(s, "FUNMAP")) {
+        TRY_REG(base, after_keyword(s, 6))
+        write_u8(out, opcode_to_byte(Opcode::FUNMAP));
+        write_u8(out, base);
+        return {};
+    }
+    if (starts_with_keyword(s, "PIPE")) {
+        auto [rfd_tok, rest] = split_comma(after_keyword(s, 4));
+        auto [wfd_tok, flag_tok] = split_comma(rest);
+        TRY_FD(rfd, rfd_tok)
+        TRY_FD(wfd, wfd_tok)
+        if (rfd == wfd) {
+            return err("PIPE needs two different file descriptors");
+        }
+        uint8_t flags = 0;
+        if (!flag_tok.empty()) {
+            if (flag_tok != "NONBLOCK" && flag_tok != "nonblock") {
+                return err("expected NONBLOCK flag in PIPE");
+            }
+            flags |= FD_NONBLOCK;
+        }
+        write_u8(out, opcode_to_byte(Opcode::PIPE));
+        write_u8(out, flags);
+        write_u8(out, rfd);
+        write_u8(out, wfd);
+        return {};
+    }
+    if (starts_with_keyword(s, "POLL")) {
+        auto [dst_tok, rest] = split_comma(after_keyword(s, 4));
+        auto [addr_tok, rest2] = split_comma(rest);
+        auto [count_tok, timeout_tok] = split_comma(rest2);
+        TRY_REG(dst, dst_tok)
+        auto addr = parse_operand(addr_tok, ctx);
+        if (!addr) {
+            return std::unexpected(addr.error());
+        }
+        if (!is_heap(addr->kind)) {
+            return err("POLL fd list must be a heap address");
+        }
+        auto count = parse_operand(count_tok, ctx);
+        if (!count) {
+            return std::unexpected(count.error());
+        }
+        auto timeout = parse_operand(timeout_tok, ctx);
+        if (!timeout) {
+            return std::unexpected(timeout.error());
+        }
+        for (const auto* op : {&*count, &*timeout}) {
+            if (op->kind != Operand::Kind::Reg && op->kind != Operand::Kind::Imm) {
+                return err("POLL count and timeout must be register or immediate");
+            }
+        }
+        write_u8(out, opcode_to_byte(Opcode::POLL));
+        write_u8(out, dst);
+        encode_operand(*addr, out);
+        encode_operand(*count, out);
+        encode_operand(*timeout, out);
+        return {};
+    }
     if (starts_with_keyword(s, "FSEEK")) {
         auto [fd_tok, val_tok] = split_comma(after_keyword(s, 5));
         TRY_FD(fd, fd_tok)
@@ -1479,29 +2152,76 @@ std::expected<void, std::string> encode(std::string_view line, const OperandCont
         return {};
     }
 
-    if (starts_with_keyword(s, "EXEC")) {
-        auto rest = after_keyword(s, 4);
+    if (starts_with_keyword(s, "EXEC") || starts_with_keyword(s, "EXECBG")) {
+        bool bg = starts_with_keyword(s, "EXECBG");
+        const char* name = bg ? "EXECBG" : "EXEC";
+        auto rest = after_keyword(s, bg ? 6 : 4);
         size_t pos = 0;
         auto cmd = parse_quoted(rest, pos);
         if (!cmd) {
-            return err("expected quoted command in EXEC");
+            return err(std::format("expected quoted command in {}", name));
         }
         if (cmd->size() > static_cast<size_t>(std::numeric_limits<uint32_t>::max())) {
-            return err("command too long in EXEC");
+            return err(std::format("command too long in {}", name));
         }
         auto after = trim(rest.substr(pos));
         if (after.empty() || after[0] != ',') {
-            return err("expected register after command in EXEC");
+            return err(std::format("expected register after command in {}", name));
         }
-        TRY_REG(r, after.substr(1))
-        write_u8(out, opcode_to_byte(Opcode::EXEC));
-        write_u8(out, r);
-        write_u32(out, static_cast<uint32_t>(cmd->size()));
-        for (char c : *cmd) {
+        auto [reg_tok, opt_tok] = split_comma(after.substr(1));
+        TRY_REG(r, reg_tok)
+
+        // EXEC "cmd", Rstatus[, Rout][, NOSHELL]; the plain form keeps the old system() opcode
+        uint8_t flags = 0;
+        uint8_t out_reg = 0;
+        auto [first_opt, second_opt] = split_comma(opt_tok);
+        for (auto opt : {first_opt, second_opt}) {
+            if (opt.empty()) {
+                continue;
+            }
+            if (opt == "NOSHELL" || opt == "noshell") {
+                flags |= EXEC_NOSHELL;
+            } else if (!bg && !(flags & (EXEC_CAPTURE | EXEC_NOSHELL))) {
+                TRY_REG(o, opt)
+                out_reg = o;
+                flags |= EXEC_CAPTURE;
+            } else {
+                return err(std::format("unexpected operand '{}' in {}", opt, name));
+            }
+        }
+        std::string payload = (flags & EXEC_NOSHELL) ? split_args(*cmd) : std::string(*cmd);
+        if ((flags & EXEC_NOSHELL) && payload.empty()) {
+            return err(std::format("empty command in {}", name));
+        }
+
+        if (bg) {
+            write_u8(out, opcode_to_byte(Opcode::EXECBG));
+            write_u8(out, flags);
+            write_u8(out, r);
+        } else if (flags) {
+            write_u8(out, opcode_to_byte(Opcode::EXECX));
+            write_u8(out, flags);
+            write_u8(out, r);
+            write_u8(out, out_reg);
+        } else {
+            write_u8(out, opcode_to_byte(Opcode::EXEC));
+            write_u8(out, r);
+        }
+        write_u32(out, static_cast<uint32_t>(payload.size()));
+        for (char c : payload) {
             write_u8(out, static_cast<uint8_t>(c));
         }
         return {};
     }
+    if (starts_with_keyword(s, "EXECWAIT")) {
+        auto [dst_tok, job_tok] = split_comma(after_keyword(s, 8));
+        TRY_REG(dst, dst_tok)
+        TRY_REG(job, job_tok)
+        write_u8(out, opcode_to_byte(Opcode::EXECWAIT));
+        write_u8(out, dst);
+        write_u8(out, job);
+        return {};
+    }
     if (starts_with_keyword(s, "SLEEP")) {
         auto src = parse_operand(trim(after_keyword(s, 5)), ctx);
         if (!src) {
@@ -1514,6 +2234,311 @@ std::expected<void, std::string> encode(std::string_view line, const OperandCont
         encode_operand(*src, out);
         return {};
     }
+    if (starts_with_keyword(s, "SCRINIT")) {
+        auto [w_tok, h_tok] = split_comma(after_keyword(s, 7));
+        auto w = parse_operand(w_tok, ctx);
+        if (!w) {
+            return std::unexpected(w.error());
+        }
+        auto h = parse_operand(h_tok, ctx);
+        if (!h) {
+            return std::unexpected(h.error());
+        }
+        write_u8(out, opcode_to_byte(Opcode::SCRINIT));
+        encode_operand(*w, out);
+        encode_operand(*h, out);
+        return {};
+    }
+    if (starts_with_keyword(s, "SCRPUT")) {
+        auto [x_tok, rest] = split_comma(after_keyword(s, 6));
+        auto [y_tok, ch_tok] = split_comma(rest);
+        auto x = parse_operand(x_tok, ctx);
+        if (!x) {
+            return std::unexpected(x.error());
+        }
+        auto y = parse_operand(y_tok, ctx);
+        if (!y) {
+            return std::unexpected(y.error());
+        }
+        auto ch = parse_operand(ch_tok, ctx);
+        if (!ch) {
+            return std::unexpected(ch.error());
+        }
+        write_u8(out, opcode_to_byte(Opcode::SCRPUT));
+        encode_operand(*x, out);
+        encode_operand(*y, out);
+        encode_operand(*ch, out);
+        return {};
+    }
+    if (starts_with_keyword(s, "SCRBLIT")) {
+        auto addr = parse_operand(trim(after_keyword(s, 7)), ctx);
+        if (!addr) {
+            return std::unexpected(addr.error());
+        }
+        if (!is_heap(addr->kind)) {
+            return err("SCRBLIT source must be a heap address");
+        }
+        write_u8(out, opcode_to_byte(Opcode::SCRBLIT));
+        encode_operand(*addr, out);
+        return {};
+    }
+    if (starts_with_keyword(s, "SCRFLUSH")) {
+        write_u8(out, opcode_to_byte(Opcode::SCRFLUSH));
+        return {};
+    }
+    // packed heap access: loads take dst, heap, index; stores take heap, index, value
+    struct PackedAccess {
+        std::string_view name;
+        Opcode opcode;
+        bool store;
+    };
+    static constexpr PackedAccess packed_ops[] = {
+        {"LOADB", Opcode::LOADB, false},   {"LOADW", Opcode::LOADW, false},
+        {"LOADD", Opcode::LOADD, false},   {"LOADSB", Opcode::LOADSB, false},
+        {"LOADSW", Opcode::LOADSW, false}, {"LOADSD", Opcode::LOADSD, false},
+        {"STOREB", Opcode::STOREB, true},  {"STOREW", Opcode::STOREW, true},
+        {"STORED", Opcode::STORED, true},
+    };
+    for (const PackedAccess& p : packed_ops) {
+        if (!starts_with_keyword(s, p.name)) {
+            continue;
+        }
+        auto [first_tok, rest] = split_comma(after_keyword(s, p.name.size()));
+        auto [second_tok, third_tok] = split_comma(rest);
+        std::string_view addr_tok = p.store ? first_tok : second_tok;
+        std::string_view index_tok = p.store ? second_tok : third_tok;
+        auto addr = need_heap(addr_tok, std::format("{} base", p.name));
+        if (!addr) {
+            return std::unexpected(addr.error());
+        }
+        auto index = need_value(index_tok, std::format("{} index", p.name));
+        if (!index) {
+            return std::unexpected(index.error());
+        }
+        if (p.store) {
+            auto value = need_value(third_tok, std::format("{} value", p.name));
+            if (!value) {
+                return std::unexpected(value.error());
+            }
+            write_u8(out, opcode_to_byte(p.opcode));
+            encode_operand(*addr, out);
+            encode_operand(*index, out);
+            encode_operand(*value, out);
+            return {};
+        }
+        TRY_REG(dst, first_tok)
+        write_u8(out, opcode_to_byte(p.opcode));
+        write_u8(out, dst);
+        encode_operand(*addr, out);
+        encode_operand(*index, out);
+        return {};
+    }
+    if (starts_with_keyword(s, "HEAPFIND")) {
+        auto [dst_tok, rest] = split_comma(after_keyword(s, 8));
+        auto [addr_tok, rest2] = split_comma(rest);
+        auto [count_tok, value_tok] = split_comma(rest2);
+        TRY_REG(dst, dst_tok)
+        auto addr = need_heap(addr_tok, "HEAPFIND base");
+        if (!addr) {
+            return std::unexpected(addr.error());
+        }
+        auto count = need_value(count_tok, "HEAPFIND count");
+        if (!count) {
+            return std::unexpected(count.error());
+        }
+        auto value = need_value(value_tok, "HEAPFIND value");
+        if (!value) {
+            return std::unexpected(value.error());
+        }
+        write_u8(out, opcode_to_byte(Opcode::HEAPFIND));
+        write_u8(out, dst);
+        encode_operand(*addr, out);
+        encode_operand(*count, out);
+        encode_operand(*value, out);
+        return {};
+    }
+    if (starts_with_keyword(s, "MEMCPY") || starts_with_keyword(s, "MEMMOVE")) {
+        bool copy = starts_with_keyword(s, "MEMCPY");
+        const char* name = copy ? "MEMCPY" : "MEMMOVE";
+        auto [dst_tok, rest] = split_comma(after_keyword(s, copy ? 6 : 7));
+        auto [src_tok, count_tok] = split_comma(rest);
+        auto dst = need_heap(dst_tok, std::format("{} destination", name));
+        if (!dst) {
+            return std::unexpected(dst.error());
+        }
+        auto src = need_heap(src_tok, std::format("{} source", name));
+        if (!src) {
+            return std::unexpected(src.error());
+        }
+        auto count = need_value(count_tok, std::format("{} count", name));
+        if (!count) {
+            return std::unexpected(count.error());
+        }
+        write_u8(out, opcode_to_byte(copy ? Opcode::MEMCPY : Opcode::MEMMOVE));
+        encode_operand(*dst, out);
+        encode_operand(*src, out);
+        encode_operand(*count, out);
+        return {};
+    }
+    if (starts_with_keyword(s, "MEMSET")) {
+        auto [addr_tok, rest] = split_comma(after_keyword(s, 6));
+        auto [count_tok, value_tok] = split_comma(rest);
+        auto addr = need_heap(addr_tok, "MEMSET base");
+        if (!addr) {
+            return std::unexpected(addr.error());
+        }
+        auto count = need_value(count_tok, "MEMSET count");
+        if (!count) {
+            return std::unexpected(count.error());
+        }
+        auto value = need_value(value_tok, "MEMSET value");
+        if (!value) {
+            return std::unexpected(value.error());
+        }
+        write_u8(out, opcode_to_byte(Opcode::MEMSET));
+        encode_operand(*addr, out);
+        encode_operand(*count, out);
+        encode_operand(*value, out);
+        return {};
+    }
+    if (starts_with_keyword(s, "MEMCMP")) {
+        auto [dst_tok, rest] = split_comma(after_keyword(s, 6));
+        auto [a_tok, rest2] = split_comma(rest);
+        auto [b_tok, count_tok] = split_comma(rest2);
+        TRY_REG(dst, dst_tok)
+        auto a = need_heap(a_tok, "MEMCMP first range");
+        if (!a) {
+            return std::unexpected(a.error());
+        }
+        auto b = need_heap(b_tok, "MEMCMP second range");
+        if (!b) {
+            return std::unexpected(b.error());
+        }
+        auto count = need_value(count_tok, "MEMCMP count");
+        if (!count) {
+            return std::unexpected(count.error());
+        }
+        write_u8(out, opcode_to_byte(Opcode::MEMCMP));
+        write_u8(out, dst);
+        encode_operand(*a, out);
+        encode_operand(*b, out);
+        encode_operand(*count, out);
+        return {};
+    }
+    // element-wise vector ops share one operand layout: dst, a, b heap ranges and a length
+    struct VectorMap {
+        std::string_view name;
+        Opcode opcode;
+    };
+    static constexpr VectorMap vector_maps[] = {
+        {"VADD", Opcode::VADD}, {"VSUB", Opcode::VSUB}, {"VMUL", Opcode::VMUL},
+        {"VAND", Opcode::VAND}, {"VMIN", Opcode::VMIN}, {"VMAX", Opcode::VMAX},
+    };
+    for (const VectorMap& v : vector_maps) {
+        if (!starts_with_keyword(s, v.name)) {
+            continue;
+        }
+        auto [dst_tok, rest] = split_comma(after_keyword(s, v.name.size()));
+        auto [a_tok, rest2] = split_comma(rest);
+        auto [b_tok, len_tok] = split_comma(rest2);
+        auto dst = need_heap(dst_tok, std::format("{} destination", v.name));
+        if (!dst) {
+            return std::unexpected(dst.error());
+        }
+        auto a = need_heap(a_tok, std::format("{} first operand", v.name));
+        if (!a) {
+            return std::unexpected(a.error());
+        }
+        auto b = need_heap(b_tok, std::format("{} second operand", v.name));
+        if (!b) {
+            return std::unexpected(b.error());
+        }
+        auto len = need_value(len_tok, std::format("{} length", v.name));
+        if (!len) {
+            return std::unexpected(len.error());
+        }
+        write_u8(out, opcode_to_byte(v.opcode));
+        encode_operand(*dst, out);
+        encode_operand(*a, out);
+        encode_operand(*b, out);
+        encode_operand(*len, out);
+        return {};
+    }
+    if (starts_with_keyword(s, "VSUM")) {
+        auto [dst_tok, rest] = split_comma(after_keyword(s, 4));
+        auto [addr_tok, len_tok] = split_comma(rest);
+        TRY_REG(dst, dst_tok)
+        auto addr = need_heap(addr_tok, "VSUM base");
+        if (!addr) {
+            return std::unexpected(addr.error());
+        }
+        auto len = need_value(len_tok, "VSUM length");
+        if (!len) {
+            return std::unexpected(len.error());
+        }
+        write_u8(out, opcode_to_byte(Opcode::VSUM));
+        write_u8(out, dst);
+        encode_operand(*addr, out);
+        encode_operand(*len, out);
+        return {};
+    }
+    if (starts_with_keyword(s, "VDOT")) {
+        auto [dst_tok, rest] = split_comma(after_keyword(s, 4));
+        auto [a_tok, rest2] = split_comma(rest);
+        auto [b_tok, len_tok] = split_comma(rest2);
+        TRY_REG(dst, dst_tok)
+        auto a = need_heap(a_tok, "VDOT first operand");
+        if (!a) {
+            return std::unexpected(a.error());
+        }
+        auto b = need_heap(b_tok, "VDOT second operand");
+        if (!b) {
+            return std::unexpected(b.error());
+        }
+        auto len = need_value(len_tok, "VDOT length");
+        if (!len) {
+            return std::unexpected(len.error());
+        }
+        write_u8(out, opcode_to_byte(Opcode::VDOT));
+        write_u8(out, dst);
+        encode_operand(*a, out);
+        encode_operand(*b, out);
+        encode_operand(*len, out);
+        return {};
+    }
+    if (starts_with_keyword(s, "RANDFILL")) {
+        auto [addr_tok, rest] = split_comma(after_keyword(s, 8));
+        auto [count_tok, ranges] = split_comma(rest);
+        auto addr = parse_operand(addr_tok, ctx);
+        if (!addr) {
+            return std::unexpected(addr.error());
+        }
+        if (!is_heap(addr->kind)) {
+            return err("RANDFILL address must be a heap address");
+        }
+        auto count = parse_operand(count_tok, ctx);
+        if (!count) {
+            return std::unexpected(count.error());
+        }
+        int64_t min_val = INT64_MIN;
+        int64_t max_val = INT64_MAX;
+        if (!ranges.empty()) {
+            auto [min_tok, max_tok] = split_comma(ranges);
+            auto mn = parse_i64(min_tok);
+            auto mx = parse_i64(max_tok);
+            if (!mn || !mx) {
+                return err("invalid range in RANDFILL");
+            }
+            min_val = *mn;
+            max_val = *mx;
+        }
+        write_u8(out, opcode_to_byte(Opcode::RANDFILL));
+        encode_operand(*addr, out);
+        encode_operand(*count, out);
+        write_i64(out, min_val);
+        write_i64(out, max_val);
+        return {};
+    }
     if (starts_with_keyword(s, "RAND")) {
         auto rest = after_keyword(s, 4);
         auto [reg_tok, ranges] = split_comma(rest);
@@ -1647,6 +2672,21 @@ std::expected<void, std::string> encode(std::string_view line, const OperandCont
         write_u8(out, r);
         return {};
     }
+    if (starts_with_keyword(s, "REFUEL")) {
+        auto src = parse_operand(trim(after_keyword(s, 6)), ctx);
+        if (!src) {
+            return std::unexpected(src.error());
+        }
+        write_u8(out, opcode_to_byte(Opcode::REFUEL));
+        encode_operand(*src, out);
+        return {};
+    }
+    if (starts_with_keyword(s, "GETFUEL")) {
+        TRY_REG(r, after_keyword(s, 7))
+        write_u8(out, opcode_to_byte(Opcode::GETFUEL));
+        write_u8(out, r);
+        return {};
+    }
     if (starts_with_keyword(s, "SETPERM")) {
         auto rest = after_keyword(s, 7);
         auto [start_tok, rest2] = split_comma(rest);
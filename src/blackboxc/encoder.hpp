@@ -18,9 +18,26 @@ namespace bbxc::encoder {
 
 
 struct Operand {
-    enum class Kind { Reg, Imm, Imm64, Bss, BssRef, Var, Data, Label, FD, HeapAddr, HeapReg, VarReg };
+    enum class Kind {
+        Reg,
+        Imm,
+        Imm64,
+        Bss,
+        BssRef,
+        Var,
+        Data,
+        Label,
+        FD,
+        HeapAddr,
+        HeapReg,
+        VarReg,
+        HeapIndexed
+    };
     Kind kind = Kind::Imm;
     uint8_t reg = 0;
+    // HeapIndexed: reg is the base, imm the displacement; 0xFF means no register
+    uint8_t index = 0xFF;
+    uint8_t scale = 1;
     int32_t imm = 0;
     int64_t imm64 = 0;
     uint32_t idx = 0;
@@ -9,8 +9,16 @@ constexpr size_t MAGIC_SIZE = 3;
 // header: magic(3) - global_count(4) - entry_count(4)
 constexpr size_t HEADER_FIXED_SIZE = 11;
 constexpr size_t REGISTERS = 99;
+constexpr uint8_t NO_REGISTER = 0xFF; // absent base or index of a HeapIndexed operand
 constexpr size_t FILE_DESCRIPTORS = 99;
 constexpr size_t MAX_SYSCALLS = 256;
+constexpr size_t MAX_CHANNELS = 16;
+constexpr uint8_t CHANNEL_STRING = 0x01;
+constexpr size_t MAX_SCREEN_SIZE = 1024; // cells per side
+constexpr uint8_t FD_NONBLOCK = 0x80; // FOPEN mode bit and PIPE flag
+constexpr size_t MAX_POLL_FDS = 64;
+constexpr uint8_t EXEC_CAPTURE = 0x01;
+constexpr uint8_t EXEC_NOSHELL = 0x02;
 
 // ts will not change because we are not bringing back whatever we had before
 enum class DataEntryType : uint8_t {
@@ -40,6 +48,7 @@ enum class OperandType : uint8_t {
     HeapAddr = 0x07,   // 4 bytes: heap address
     HeapReg = 0x08, // 1 byte heap addr in reg
     VarReg = 0x09, // 1 byte var slot in reg
+    HeapIndexed = 0x0A, // 1 byte base reg, 1 byte index reg, 1 byte scale, 4 bytes i32 disp
 };
 
 enum class Opcode : uint8_t {
@@ -71,6 +80,9 @@ enum class Opcode : uint8_t {
     CALL = 0x1D,
     RET = 0x1E,
     HLT = 0x1F,
+    LOOP = 0x20,
+    HALLOC = 0x22,
+    HFREE = 0x23,
     LOADREF = 0x24,
     STOREREF = 0x25,
     LOADSTR = 0x26,
@@ -78,6 +90,11 @@ enum class Opcode : uint8_t {
     GROW = 0x28,
     RESIZE = 0x29,
     FREE = 0x2A,
+    MEMCPY = 0x2B,
+    MEMSET = 0x2C,
+    MEMCMP = 0x2D,
+    MEMMOVE = 0x2E,
+    HEAPFIND = 0x2F,
     WRITE = 0x30,
     PRINT = 0x31,
     NEWLINE = 0x32,
@@ -90,19 +107,34 @@ enum class Opcode : uint8_t {
     READ = 0x39,
     READSTR = 0x3A,
     READCHAR = 0x3B,
+    SCRINIT = 0x3C,
+    SCRPUT = 0x3D,
+    SCRBLIT = 0x3E,
+    SCRFLUSH = 0x3F,
     FOPEN = 0x40,
     FCLOSE = 0x41,
     FREAD = 0x42,
     FWRITE = 0x43,
+    FCOPY = 0x44,
     FSEEK = 0x45,
+    FREADNB = 0x46,
+    FWRITENB = 0x47,
+    POLL = 0x48,
+    PIPE = 0x49,
+    FMAP = 0x4A,
+    FUNMAP = 0x4B,
     EXEC = 0x50,
     SLEEP = 0x51,
+    RANDFILL = 0x52,
     RAND = 0x53,
     GETKEY = 0x54,
     CLRSCR = 0x55,
     GETARG = 0x56,
     GETARGC = 0x57,
     GETENV = 0x58,
+    EXECX = 0x59,
+    EXECBG = 0x5A,
+    EXECWAIT = 0x5B,
     SYSCALL = 0x60,
     SYSRET = 0x61,
     DROPPRIV = 0x62,
@@ -112,6 +144,58 @@ enum class Opcode : uint8_t {
     REGFAULT = 0x66,
     FAULTRET = 0x67,
     GETFAULT = 0x68,
+    REFUEL = 0x69,
+    GETFUEL = 0x6A,
+    COCREATE = 0x70,
+    YIELD = 0x71,
+    RESUME = 0x72,
+    CAS = 0x74,
+    FETCHADD = 0x75,
+    XCHG = 0x76,
+    WAIT = 0x77,
+    WAKE = 0x78,
+    CHSEND = 0x7A,
+    CHRECV = 0x7B,
+    CHTRY = 0x7C,
+    STRCAT = 0x80,
+    STRLEN = 0x81,
+    SUBSTR = 0x82,
+    STRCMP = 0x83,
+    CHARAT = 0x84,
+    STRFROMHEAP = 0x85,
+    STRFIND = 0x86,
+    STRCHR = 0x87,
+    STRSPLIT = 0x88,
+    ITOA = 0x89,
+    ATOI = 0x8A,
+    STRFMT = 0x8B,
+    VADD = 0x90,
+    VSUB = 0x91,
+    VMUL = 0x92,
+    VAND = 0x93,
+    VMIN = 0x94,
+    VMAX = 0x95,
+    VSUM = 0x96,
+    VDOT = 0x97,
+    LOADB = 0xA0,
+    LOADW = 0xA1,
+    LOADD = 0xA2,
+    STOREB = 0xA3,
+    STOREW = 0xA4,
+    STORED = 0xA5,
+    LOADSB = 0xA6,
+    LOADSW = 0xA7,
+    LOADSD = 0xA8,
+    ADD3 = 0xB0,
+    SUB3 = 0xB1,
+    MUL3 = 0xB2,
+    DIV3 = 0xB3,
+    MOD3 = 0xB4,
+    AND3 = 0xB5,
+    OR3 = 0xB6,
+    XOR3 = 0xB7,
+    SHL3 = 0xB8,
+    SHR3 = 0xB9,
     BREAK = 0xFD,
     NOP = 0xFE,
     DUMPREGS = 0xF0,
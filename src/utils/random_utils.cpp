@@ -43,5 +43,15 @@ uint64_t get_true_random() {
 #endif
 }
 
+void Xoshiro256pp::reseed(uint64_t seed) {
+    for (auto& word : s) {
+        seed += 0x9E3779B97F4A7C15ULL;
+        uint64_t z = seed;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        word = z ^ (z >> 31);
+    }
+}
+
 } // namespace tools
 } // namespace blackbox
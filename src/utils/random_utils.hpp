@@ -2,10 +2,74 @@
 
 #include <cstdint>
 
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
 namespace blackbox {
 namespace tools {
 
 uint64_t get_true_random();
 
+// xoshiro256++ (Blackman & Vigna). fast and statistically solid; not for secrets
+class Xoshiro256pp {
+  public:
+    explicit Xoshiro256pp(uint64_t seed = 0) { reseed(seed); }
+
+    // expands the seed with splitmix64 so that nearby seeds give unrelated streams
+    void reseed(uint64_t seed);
+
+    uint64_t next() {
+        uint64_t result = rotl(s[0] + s[3], 23) + s[0];
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    // uniform in [0, range) without modulo bias (Lemire's multiply-and-reject); range > 0
+    uint64_t bounded(uint64_t range) {
+        uint64_t lo;
+        uint64_t hi = mul_wide(next(), range, lo);
+        if (lo < range) {
+            uint64_t threshold = (0 - range) % range;
+            while (lo < threshold) {
+                hi = mul_wide(next(), range, lo);
+            }
+        }
+        return hi;
+    }
+
+    // uniform in [min, max]; min <= max
+    int64_t uniform(int64_t min, int64_t max) {
+        uint64_t range = static_cast<uint64_t>(max) - static_cast<uint64_t>(min) + 1;
+        if (range == 0) {
+            return static_cast<int64_t>(next());
+        }
+        return static_cast<int64_t>(static_cast<uint64_t>(min) + bounded(range));
+    }
+
+  private:
+    uint64_t s[4];
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    static uint64_t mul_wide(uint64_t a, uint64_t b, uint64_t& lo) {
+#if defined(_MSC_VER) && !defined(__clang__)
+        uint64_t hi;
+        lo = _umul128(a, b, &hi);
+        return hi;
+#else
+        unsigned __int128 p = static_cast<unsigned __int128>(a) * b;
+        lo = static_cast<uint64_t>(p);
+        return static_cast<uint64_t>(p >> 64);
+#endif
+    }
+};
+
 } // namespace tools
 } // namespace blackbox